@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
 
 TARGET = MPlot
 TEMPLATE = lib
@@ -27,6 +27,13 @@ HEADERS += src/MPlot/MPlot_global.h \
 		src/MPlot/MPlotLegend.h \
 		src/MPlot/MPlotMarker.h \
 		src/MPlot/MPlotSeriesData.h \
+		src/MPlot/MPlotTypedSeriesData.h \
+		src/MPlot/MPlotFileSeriesData.h \
+		src/MPlot/MPlotRingBuffer.h \
+		src/MPlot/MPlotSpscQueue.h \
+		src/MPlot/MPlotMinMaxPyramid.h \
+		src/MPlot/MPlotSegmentIndex.h \
+		src/MPlot/MPlotSimd.h \
 		src/MPlot/MPlotTools.h \
 		src/MPlot/MPlotAbstractTool.h \
 		src/MPlot/MPlotItem.h \
@@ -34,6 +41,7 @@ HEADERS += src/MPlot/MPlot_global.h \
 		src/MPlot/MPlotColorMap.h \
 		src/MPlot/MPlotImage.h \
 		src/MPlot/MPlotImageData.h \
+		src/MPlot/MPlotTypedImageData.h \
 		src/MPlot/MPlotPoint.h \
 		src/MPlot/MPlotAxisScale.h \
 		src/MPlot/MPlotRectangle.h \
@@ -53,6 +61,10 @@ SOURCES += src/MPlot/MPlot.cpp \
 		src/MPlot/MPlotPoint.cpp \
 		src/MPlot/MPlotSeries.cpp \
 		src/MPlot/MPlotSeriesData.cpp \
+		src/MPlot/MPlotFileSeriesData.cpp \
+		src/MPlot/MPlotMinMaxPyramid.cpp \
+		src/MPlot/MPlotSegmentIndex.cpp \
+		src/MPlot/MPlotSimd.cpp \
 		src/MPlot/MPlotTools.cpp \
 		src/MPlot/MPlotWidget.cpp \
 		src/MPlot/MPlotAxisScale.cpp \
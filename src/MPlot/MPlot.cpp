@@ -8,6 +8,8 @@
 #include "MPlot/MPlotImage.h"
 #include "MPlot/MPlotAbstractTool.h"
 
+#include <QTimer>
+
 MPlotSignalHandler::MPlotSignalHandler(MPlot* parent)
 	: QObject(0) {
 	plot_ = parent;
@@ -42,6 +44,15 @@ MPlot::MPlot(const QRectF& rect, QGraphicsItem* parent) :
 	// No auto-scale scheduled right now.
 	autoScaleScheduled_ = false;
 
+	// No update rate limit by default: changes are handled as soon as they happen.
+	maximumUpdateRate_ = 0;
+	adaptiveUpdateRate_ = true;
+	updateInterval_ = 0;
+	lastPaintTime_ = 0;
+	frameTimer_ = new QTimer(signalHandler_);
+	frameTimer_->setSingleShot(true);
+	QObject::connect(frameTimer_, SIGNAL(timeout()), signalHandler_, SLOT(doDeferredUpdates()));
+
 	setFlags(QGraphicsItem::ItemHasNoContents);	// drawing optimization; all drawing done by children
 
 	// Create background rectangle of the given size, as a child of this QGraphicsObject.
@@ -176,6 +187,7 @@ bool MPlot::removeItem(MPlotItem* removeMe) {
 			removeMe->setParentItem(0);
 
 		items_.removeAll(removeMe);
+		deferredItems_.removeAll(removeMe);
 
 		legend()->onLegendContentChanged(removeMe);
 
@@ -294,8 +306,6 @@ void MPlot::onAxisScaleAutoScaleEnabledChanged(bool autoScaleEnabled) {
 		scheduleDelayedAutoScale();
 }
 
-#include <QTimer>
-
 void MPlot::onBoundsChanged(MPlotItem *source) {
 
 	if(source->ignoreWhenAutoScaling())
@@ -319,10 +329,75 @@ void MPlot::onBoundsChanged(MPlotItem *source) {
 void MPlot::scheduleDelayedAutoScale() {
 	if(!autoScaleScheduled_) {
 		autoScaleScheduled_ = true;
-		QTimer::singleShot(0, signalHandler_, SLOT(doDelayedAutoscale()));
+		if(maximumUpdateRate_ > 0)
+			scheduleFrame();
+		else
+			QTimer::singleShot(0, signalHandler_, SLOT(doDelayedAutoscale()));
 	}
 }
 
+void MPlot::scheduleDeferredUpdate(MPlotItem *item)
+{
+	if(!deferredItems_.contains(item))
+		deferredItems_ << item;
+	scheduleFrame();
+}
+
+void MPlot::scheduleFrame()
+{
+	if(frameTimer_->isActive())
+		return;
+
+	qreal wait = 0;
+	if(lastFrameTime_.isValid())
+		wait = updateInterval_ - lastFrameTime_.elapsed();
+	frameTimer_->start(qMax(0, int(wait)));
+}
+
+void MPlot::setMaximumUpdateRate(qreal updatesPerSecond)
+{
+	maximumUpdateRate_ = qMax(qreal(0), updatesPerSecond);
+	updateInterval_ = minimumUpdateInterval();
+
+	if(maximumUpdateRate_ == 0) {
+		frameTimer_->stop();
+		flushDeferredUpdates();
+	}
+	else if(frameTimer_->isActive()) {
+		// Re-time the pending frame for the new rate.
+		frameTimer_->stop();
+		scheduleFrame();
+	}
+}
+
+void MPlot::flushDeferredUpdates()
+{
+	QElapsedTimer frameCost;
+	frameCost.start();
+
+	frameTimer_->stop();
+
+	// Items may defer again while flushing (ex: if handling the change touches the data); those wait for the next frame.
+	QList<MPlotItem*> items = deferredItems_;
+	deferredItems_.clear();
+	foreach(MPlotItem* item, items)
+		item->flushDeferredDataChange();
+
+	doDelayedAutoScale();
+
+	lastFrameTime_.start();
+
+	if(maximumUpdateRate_ <= 0 || !adaptiveUpdateRate_)
+		return;
+
+	// Keep frames to at most half of the interval, so that the event loop stays responsive.  The paint for this frame hasn't happened yet; the last one is a good estimate.
+	qreal cost = frameCost.elapsed() + lastPaintTime_;
+	if(cost > updateInterval_/2)
+		updateInterval_ = qMin(qreal(1000), qMax(updateInterval_*1.5, cost*2));
+	else if(cost < updateInterval_/4)
+		updateInterval_ = qMax(minimumUpdateInterval(), updateInterval_/1.25);
+}
+
 void MPlot::onSelectedChanged(MPlotItem *source, bool isSelected) {
 	Q_UNUSED(source)
 	Q_UNUSED(isSelected)
@@ -411,6 +486,11 @@ void MPlotSignalHandler::onAxisScaleAutoScaleEnabledChanged(bool enabled)
 	plot_->onAxisScaleAutoScaleEnabledChanged(enabled);
 }
 
+void MPlotSignalHandler::doDeferredUpdates()
+{
+	plot_->flushDeferredUpdates();
+}
+
 void MPlot::enableLogScale(int axisScaleIndex, bool logScaleOn)
 {
 	axisScaleLogScaleOn_[axisScaleIndex] = logScaleOn;
@@ -534,6 +614,43 @@ int MPlot::seriesItemsCount() const
 	return rv;
 }
 
+MPlotNearestPoint MPlot::nearestDataPoint(const QPointF &drawingPosition, qreal maxDistance) const
+{
+	MPlotNearestPoint result;
+
+	foreach(MPlotItem* item, items_) {
+		MPlotAbstractSeries* series = qgraphicsitem_cast<MPlotAbstractSeries*>(item);
+		if(!series || !series->isVisible() || !series->xAxisTarget() || !series->yAxisTarget())
+			continue;
+
+		qreal distance;
+		int index = series->nearestPointIndex(drawingPosition, maxDistance, &distance);
+		if(index >= 0) {
+			result.series = series;
+			result.index = index;
+			result.distance = distance;
+			// Any other series must have a closer point.
+			maxDistance = distance;
+		}
+	}
+
+	if(result.isValid()) {
+		result.value = result.series->transformedValue(result.index);
+		result.drawingPosition = QPointF(result.series->xAxisTarget()->mapDataToDrawing(result.value.x()),
+										 result.series->yAxisTarget()->mapDataToDrawing(result.value.y()));
+	}
+
+	return result;
+}
+
+MPlotNearestPoint MPlot::nearestDataPoint(const QPointF &dataPosition, const MPlotAxisScale *xAxisScale, const MPlotAxisScale *yAxisScale, qreal maxDistance) const
+{
+	if(!xAxisScale || !yAxisScale)
+		return MPlotNearestPoint();
+
+	return nearestDataPoint(QPointF(xAxisScale->mapDataToDrawing(dataPosition.x()), yAxisScale->mapDataToDrawing(dataPosition.y())), maxDistance);
+}
+
 int MPlot::imageItemsCount() const
 {
 	int rv = 0;
@@ -14,8 +14,31 @@
 #include <QGraphicsItem>
 #include <QGraphicsScene>
 #include <QGraphicsRectItem>
+#include <QElapsedTimer>
 
 class MPlot;
+class QTimer;
+class MPlotAbstractSeries;
+
+/// The result of MPlot::nearestDataPoint(): a point of one of the series in the plot.
+class MPLOTSHARED_EXPORT MPlotNearestPoint {
+public:
+	/// Constructs an invalid result, for when no point was found.
+	MPlotNearestPoint() : series(0), index(-1), distance(-1) {}
+	/// Returns true if a point was found.
+	bool isValid() const { return series != 0; }
+
+	/// The series the point belongs to.
+	MPlotAbstractSeries* series;
+	/// The index of the point in the series' model.
+	int index;
+	/// The value of the point as plotted (see MPlotAbstractSeries::transformedValue()), in the data coordinates of the series' axis scales.
+	QPointF value;
+	/// The position of the point, in drawing coordinates.
+	QPointF drawingPosition;
+	/// The distance between the point and the position that was searched for, in drawing coordinates.
+	qreal distance;
+};
 
 /// This class handles signals as a proxy for MPlot.  You should never need to use this class directly.
 /*! To avoid restrictions on multiple inheritance, MPlot does not inherit QObject.  Still, it needs a way to respond to events from MPlotItems (such as re-scale and selected events).  This QObject receives signals from MPlotItem and calls the appropriate functions within MPlot.
@@ -40,6 +63,8 @@ protected slots:
 	void doDelayedAutoscale();
 	/// This slot flags the plot that it needs to perform an autoscale the next time it returns to the event loop.
 	void onAxisScaleAutoScaleEnabledChanged(bool enabled);
+	/// Called by the frame timer when the plot limits its update rate.  Calls MPlot::flushDeferredUpdates().
+	void doDeferredUpdates();
 
 signals:
 	/// Notifer that the data position has been updated.  Passes the index of item inside the position indicator tool and the new position (in data coordinates).  Only emitted when the MPlotDataPositionTool has been added to the plot.
@@ -128,6 +153,11 @@ public:
 	QList<MPlotItem*> plotItems() const { return items_; }
 	/// Counts the number of MPlotAbstractSeries items in this plot.
 	int seriesItemsCount() const;
+	/// Finds the data point closest to \c drawingPosition (in drawing coordinates), among all the visible series in this plot, and closer than \c maxDistance (a negative value means no limit).  Returns an invalid MPlotNearestPoint if there isn't one.
+	/*! Each series is searched with MPlotAbstractSeries::nearestPointIndex(), which uses a binary search when the x-values are sorted, so this is fast enough to call on every mouse move.  The distance found so far limits the search in the next series. */
+	MPlotNearestPoint nearestDataPoint(const QPointF& drawingPosition, qreal maxDistance = -1) const;
+	/// Overloaded: finds the data point closest to \c dataPosition, given in the data coordinates of \c xAxisScale and \c yAxisScale.  Distances are still measured in drawing coordinates, so that the x and y directions count the same way they look.
+	MPlotNearestPoint nearestDataPoint(const QPointF& dataPosition, const MPlotAxisScale* xAxisScale, const MPlotAxisScale* yAxisScale, qreal maxDistance = -1) const;
 	/// Counts the number of MPlotAbstractImage items in this plot
 	int imageItemsCount() const;
 
@@ -230,6 +260,25 @@ public:
 	/// Called automatically when control returns to the event loop, this completes a delayed autoscale. (Recomputing the scale limits is optimized to be only done when necessary, rather than whenever the data values change.)  If you need the scene to be updated NOW! (for example, you're working outside of an event loop, or rendering before returning to the event loop), you can call this manually.
 	void doDelayedAutoScale();
 
+	/// Limits how often the plot reacts to changing data, to at most \c updatesPerSecond times per second.  0 (the default) turns off the limit.
+	/*! Normally every data change is handled right away: the plot items recompute what they need, and the autoscale is scheduled for the next return to the event loop.  When data streams in faster than the screen can show it, most of that work is wasted.  With a limit in place, data and bounds changes from all plot items are only recorded, and are handled together once per frame: the items update, the autoscale runs, and the view repaints once.
+
+	  Turning off the limit handles any changes that are still waiting right away.
+	  */
+	void setMaximumUpdateRate(qreal updatesPerSecond);
+	/// Returns the update rate limit set with setMaximumUpdateRate(), or 0 if there is none.
+	qreal maximumUpdateRate() const { return maximumUpdateRate_; }
+	/// Enables or disables adaptive update rates.  When enabled (the default) and a frame (handling the changes, plus the last reported paint time) takes more than half of the frame interval, the interval is lengthened, up to one second; it shrinks back towards 1/maximumUpdateRate() once frames are cheap again.  Only has an effect when there is a maximumUpdateRate().
+	void setAdaptiveUpdateRateEnabled(bool enabled) { adaptiveUpdateRate_ = enabled; if(!enabled) updateInterval_ = minimumUpdateInterval(); }
+	/// Returns true if adaptive update rates are enabled.
+	bool adaptiveUpdateRateEnabled() const { return adaptiveUpdateRate_; }
+	/// Returns the current time between frames (in milliseconds) when the update rate is limited, including any adaptive back-off.  Returns 0 if there is no limit.
+	qreal currentUpdateInterval() const { return maximumUpdateRate_ > 0 ? updateInterval_ : 0; }
+	/// Tells the plot how long the last repaint took, in milliseconds.  MPlotWidget calls this automatically; if you draw the plot's scene some other way and use adaptive update rates, you can call it yourself.
+	void reportPaintTime(qreal milliseconds) { lastPaintTime_ = milliseconds; }
+	/// Handles all data and bounds changes that are waiting for the next frame right now, and then does the delayed autoscale.  Called automatically when the update rate is limited; you can call this manually before rendering outside of the event loop.
+	void flushDeferredUpdates();
+
 	/// Retrieves the overall minimum x-value from all the series contained within the plot.  If there are no series contained in the plot then MPLOT_NEG_INFINITY is returned.
 	double minimumXSeriesValue();
 	/// Retrieves the overall maximum x-value from all the series contained within the plot.  If there are no series contained in the plot then MPLOT_POS_INFINITY is returned.
@@ -253,6 +302,13 @@ protected: // "slots" (proxied through MPlotSignalHandler)
 protected:
 	/// Request a deferred auto-scale:
 	void scheduleDelayedAutoScale();
+	/// Called by plot items (through MPlotItem::deferDataChange()) to have their MPlotItem::flushDeferredDataChange() called at the next frame.
+	void scheduleDeferredUpdate(MPlotItem* item);
+	/// Starts the frame timer, if it isn't running already, so that the next frame happens no sooner than updateInterval_ after the last one.
+	void scheduleFrame();
+	/// Returns the shortest time between frames (in milliseconds), given by maximumUpdateRate().
+	qreal minimumUpdateInterval() const { return maximumUpdateRate_ > 0 ? 1000.0/maximumUpdateRate_ : 0; }
+	friend class MPlotItem;
 	/// Sets the defaults for the drawing options: margins, scale padding, background colors, initial data range.
 	void setDefaults();
 
@@ -299,6 +355,21 @@ protected:
 	/// Indicates that a re-autoscale has been scheduled (Actually doing it is deferred until returning back to the event loop)
 	bool autoScaleScheduled_;
 
+	/// The maximum number of frames per second when limiting the update rate, or 0 for no limit.
+	qreal maximumUpdateRate_;
+	/// True if the time between frames adapts to how long they take.
+	bool adaptiveUpdateRate_;
+	/// The current time between frames, in milliseconds.
+	qreal updateInterval_;
+	/// The time the last repaint took (reported by reportPaintTime()), in milliseconds.
+	qreal lastPaintTime_;
+	/// Measures the time since the last frame.
+	QElapsedTimer lastFrameTime_;
+	/// Single-shot timer that triggers the next frame.  Owned by signalHandler_.
+	QTimer* frameTimer_;
+	/// The plot items with changes waiting for the next frame.
+	QList<MPlotItem*> deferredItems_;
+
 	/// Normally, when plot items are removed, they can trigger a re-autoscale. This is expensive if the MPlot is just about to be deleted anyway, and we have a lot of plots. This optimization omits this useless process and speeds up the destructor.
 	bool gettingDeleted_;
 
@@ -1,4 +1,5 @@
 #include "MPlot/MPlotAxisScale.h"
+#include "MPlot/MPlotSimd.h"
 #include <QDebug>
 
 
@@ -97,6 +98,53 @@ void MPlotAxisScale::setDataRange(const MPlotAxisRange &newDataRange, bool apply
 	emit dataRangeChanged();
 }
 
+MPlotAxisMapping MPlotAxisScale::mapping() const
+{
+	MPlotAxisMapping rv;
+
+	qreal min = dataRange_.min();
+	qreal max = dataRange_.max();
+
+	if(fabs(dataRange_.length()) < 1e-30) {
+		rv.degenerate = true;
+		return rv;
+	}
+
+	if(logScaleEnabled_ && min > 0.0 && max > 0.0) {
+		rv.logScale = true;
+		rv.logFloor = qMin(min, max);
+		min = log10(min);
+		max = log10(max);
+	}
+
+	// Vertical: height*(1 - (v-min)/(max-min)).  Horizontal: width*(v-min)/(max-min).
+	qreal maxMinDifference = max - min;
+	if(orientation_ == Qt::Vertical) {
+		rv.scale = -drawingSize_.height()/maxMinDifference;
+		rv.offset = drawingSize_.height()*(1 + min/maxMinDifference);
+	}
+	else {
+		rv.scale = drawingSize_.width()/maxMinDifference;
+		rv.offset = -drawingSize_.width()*min/maxMinDifference;
+	}
+
+	return rv;
+}
+
+void MPlotAxisScale::mapDataValuesToDrawingValues(unsigned size, const qreal *dataValues, qreal *outputValues) const
+{
+	MPlotAxisMapping m = mapping();
+
+	if(m.degenerate) {
+		for (unsigned i = 0; i < size; i++)
+			outputValues[i] = 1;
+	}
+	else if(m.logScale)
+		MPlotSimd::logAffine(int(size), dataValues, 1.0, 0.0, m.logFloor, m.scale, m.offset, outputValues);
+	else
+		MPlotSimd::affine(int(size), dataValues, m.scale, m.offset, outputValues);
+}
+
 void MPlotAxisScale::setPadding(qreal percent) {
 	axisPadding_ = percent/100.0;
 	setDataRange(unpaddedDataRange_, true);
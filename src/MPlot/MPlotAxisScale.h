@@ -112,6 +112,43 @@ protected:
 	bool valid_;
 };
 
+/// The coefficients of an MPlotAxisScale's data-to-drawing mapping, captured so that the mapping can be applied in tight loops (or fused with other per-point work) without re-reading the axis scale for every value.
+/*! Linear axes map as: drawing = scale*value + offset.  When logScale is true, the value is first replaced by log10(value), with values <= 0 replaced by the lower end of the data range (logFloor).  When degenerate is true (the data range has zero length), every value maps to 1, the same as MPlotAxisScale::mapDataValuesToDrawingValues(). */
+class MPLOTSHARED_EXPORT MPlotAxisMapping {
+public:
+	/// Constructs an identity mapping.
+	MPlotAxisMapping() : scale(1), offset(0), logScale(false), logFloor(0), degenerate(false) {}
+
+	/// Maps one (already transformed) data value to a drawing value.
+	qreal map(qreal value) const {
+		if(degenerate)
+			return 1;
+		if(logScale)
+			value = log10(value <= 0.0 ? logFloor : value);
+		return scale*value + offset;
+	}
+
+	/// Returns true if both mappings map every value to the same place.
+	bool operator==(const MPlotAxisMapping& other) const {
+		if(degenerate || other.degenerate)
+			return degenerate == other.degenerate;
+		return scale == other.scale && offset == other.offset && logScale == other.logScale && (!logScale || logFloor == other.logFloor);
+	}
+	/// Returns true if the mappings are different.
+	bool operator!=(const MPlotAxisMapping& other) const { return !(*this == other); }
+
+	/// The multiplier applied to the (possibly logged) data value.
+	qreal scale;
+	/// The offset added after scaling.
+	qreal offset;
+	/// True if log10() is applied before scaling.
+	bool logScale;
+	/// When logScale is on, values <= 0 are replaced with this before taking the log.
+	qreal logFloor;
+	/// True if the data range has zero length, in which case everything maps to 1.
+	bool degenerate;
+};
+
 /// This class handles all the size aspects for a particular axis.  It manages the range of the axis, how big the axis should be, and some of the other specifics for the axis.  It is kind of like the model for MPlotAxis.  It holds all the relevent information and MPlotAxis paints the axis based on that information.
 class MPLOTSHARED_EXPORT MPlotAxisScale : public QObject
 {
@@ -146,90 +183,11 @@ public:
 	}
 
 	/// Maps all of the data values to drawing values.  Size contains the size of the dataValues and outputValues array.
-	void mapDataValuesToDrawingValues(unsigned size, const qreal *dataValues, qreal *outputValues) const
-	{
-		qreal min = dataRange_.min();
-		qreal max = dataRange_.max();
-
-		// Handling the log separately because if we don't have to worry about logging the data we can compute the output values in a tight loop.
-		if (logScaleEnabled_ && min > 0.0 && max > 0.0){
-
-			for (unsigned i = 0; i < size; i++){
-
-				if (dataValues[i] <= 0.0)
-					outputValues[i] = log10(qBound(qMin(min, max), dataValues[i], qMax(min, max)));
+	/*! This is the innermost loop of every series repaint, so it uses the vectorized kernels in MPlotSimd (SSE2 or AVX2, chosen at run-time). */
+	void mapDataValuesToDrawingValues(unsigned size, const qreal *dataValues, qreal *outputValues) const;
 
-				else
-					outputValues[i] = log10(dataValues[i]);
-			}
-
-			min = log10(min);
-			max = log10(max);
-
-			if (orientation_ == Qt::Vertical){
-
-				qreal height = drawingSize_.height();
-				qreal maxMinDifference = max - min;
-
-				if(fabs(dataRange_.length()) < 1e-30){
-					for (unsigned i = 0; i < size; i++)
-						outputValues[i] = 1;
-				}
-				else{
-					for (unsigned i = 0; i < size; i++)
-						outputValues[i] = height * (1 - (outputValues[i]-min)/maxMinDifference);
-				}
-			}
-
-			else {
-
-				qreal width = drawingSize_.width();
-				qreal maxMinDifference = max - min;
-
-				if(fabs(dataRange_.length()) < 1e-30){
-					for (unsigned i = 0; i < size; i++)
-						outputValues[i] = 1;
-				}
-				else{
-					for (unsigned i = 0; i < size; i++)
-						outputValues[i] = width * ((outputValues[i]-min)/maxMinDifference);
-				}
-			}
-		}
-
-		else {
-
-			if (orientation_ == Qt::Vertical){
-
-				qreal height = drawingSize_.height();
-				qreal maxMinDifference = max - min;
-
-				if(fabs(dataRange_.length()) < 1e-30){
-					for (unsigned i = 0; i < size; i++)
-						outputValues[i] = 1;
-				}
-				else{
-					for (unsigned i = 0; i < size; i++)
-						outputValues[i] = height * (1 - (dataValues[i]-min)/maxMinDifference);
-				}
-			}
-
-			else {
-
-				qreal width = drawingSize_.width();
-				qreal maxMinDifference = max - min;
-
-				if(fabs(dataRange_.length()) < 1e-30){
-					for (unsigned i = 0; i < size; i++)
-						outputValues[i] = 1;
-				}
-				else{
-					for (unsigned i = 0; i < size; i++)
-						outputValues[i] = width * ((dataValues[i]-min)/maxMinDifference);
-				}
-			}
-		}
-	}
+	/// Returns the coefficients of the current data-to-drawing mapping.  They are only valid until the data range, drawing size, orientation, or log scaling changes.
+	MPlotAxisMapping mapping() const;
 
 	/// Returns the MPlotAxisRange of the axis scale but within the confines of the scene size.
 	MPlotAxisRange mapDataToDrawing(const MPlotAxisRange& dataRange) const {
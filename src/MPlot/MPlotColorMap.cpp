@@ -3,6 +3,7 @@
 #define MPLOTCOLORMAP_CPP
 
 #include "MPlot/MPlotColorMap.h"
+#include "MPlot/MPlotSimd.h"
 
 // System-wide pre-computed values for default color maps: optimizes the creation of new default color maps. These all have a standard resolution of 256.
 QVector<QVector<QRgb>*> MPlotColorMapData::precomputedMaps_ = QVector<QVector<QRgb>*>(13,0);
@@ -18,7 +19,9 @@ MPlotColorMapData::MPlotColorMapData(const MPlotColorMapData &other)
 	  brightness_(other.brightness_),
 	  contrast_(other.contrast_),
 	  gamma_(other.gamma_),
-	  mustApplyBCG_(other.mustApplyBCG_)
+	  mustApplyBCG_(other.mustApplyBCG_),
+	  transferTable_(other.transferTable_),
+	  transferError_(other.transferError_)
 {
 }
 
@@ -332,55 +335,14 @@ bool MPlotColorMap::rgbValues(const QVector<qreal> &values, MPlotRange range, QR
 		QVector<QRgb> colorArray = d->colorArray_;
 		int colorArraySize = colorArray.size();
 
-		if (d->mustApplyBCG_){
-
-			if (gamma == 1.0){
-
-				for (int i = 0, size = values.size(); i < size; i++){
-
-					int index = (int)qRound((contrast*((values.at(i)-rangeMinimum)/rangeDifference+brightness))*lastColorArrayIndex);
-
-					if (index < 0)
-						index = 0;
-
-					else if (index >= colorArraySize)
-						index = lastColorArrayIndex;
-
-					output[i] = colorArray.at(index);
-				}
-			}
-
-			else{
-
-				for(int i = 0, size = values.size(); i < size; i++){
-
-					int index = (int)qRound((contrast*(pow((values.at(i)-rangeMinimum)/rangeDifference, gamma)+brightness))*lastColorArrayIndex);
-
-					if (index < 0)
-						index = 0;
-
-					else if (index >= colorArraySize)
-						index = lastColorArrayIndex;
-
-					output[i] = colorArray.at(index);
-				}
-			}
-		}
+		if (d->mustApplyBCG_ && gamma != 1.0)
+			rgbValuesFromTransferTable(values.constData(), values.size(), rangeMinimum, rangeDifference, lastColorArrayIndex, output);
 
 		else{
 
-			for(int i = 0, size = values.size(); i < size; i++){
-
-				int index = (int)qRound(((values.at(i)-rangeMinimum)/rangeDifference*lastColorArrayIndex));
-
-				if (index < 0)
-					index = 0;
-
-				else if (index >= colorArraySize)
-					index = lastColorArrayIndex;
-
-				output[i] = colorArray.at(index);
-			}
+			// Vectorized normalize, scale, round, clamp and look up.  Without brightness and contrast, (1*(x+0)) is exactly x, so this gives the same indexes as the plain formula.
+			bool applyBC = d->mustApplyBCG_;
+			MPlotSimd::colorLookup(values.size(), values.constData(), rangeMinimum, rangeDifference, applyBC ? brightness : 0.0, applyBC ? contrast : 1.0, lastColorArrayIndex, colorArray.constData(), colorArraySize, output);
 		}
 	}
 
@@ -392,62 +354,20 @@ bool MPlotColorMap::rgbValues(const QVector<qreal> &values, QRgb *output)
 	if (d->recomputeCachedColorsRequired_)
 		d->recomputeCachedColors();
 
-	int lastColorArrayIndex = d->colorArray_.size() - 1;
 	qreal contrast = d->contrast_;
 	qreal brightness = d->brightness_;
 	qreal gamma = d->gamma_;
 	QVector<QRgb> colorArray = d->colorArray_;
 	int colorArraySize = colorArray.size();
 
-	if (d->mustApplyBCG_){
-
-		if (d->gamma_ == 1.0){
-
-			for (int i = 0, size = values.size(); i < size; i++){
-
-				int index = (int)qRound((contrast*(values.at(i)+brightness))*colorArraySize);
-
-				if (index < 0)
-					index = 0;
-
-				else if (index >= colorArraySize)
-					index = lastColorArrayIndex;
-
-				output[i] = colorArray.at(index);
-			}
-		}
-
-		else{
-
-			for(int i = 0, size = values.size(); i < size; i++){
-
-				int index = (int)qRound((contrast*(pow(values.at(i), gamma)+brightness))*colorArraySize);
-
-				if (index < 0)
-					index = 0;
-
-				else if (index >= colorArraySize)
-					index = lastColorArrayIndex;
-
-				output[i] = colorArray.at(index);
-			}
-		}
-	}
+	if (d->mustApplyBCG_ && gamma != 1.0)
+		rgbValuesFromTransferTable(values.constData(), values.size(), 0.0, 1.0, colorArraySize, output);
 
 	else{
 
-		for(int i = 0, size = values.size(); i < size; i++){
-
-			int index = (int)qRound((values.at(i)*colorArraySize));
-
-			if (index < 0)
-				index = 0;
-
-			else if (index >= colorArraySize)
-				index = lastColorArrayIndex;
-
-			output[i] = colorArray.at(index);
-		}
+		// (The values are already normalized: minimum 0 and range 1 leave them unchanged.)
+		bool applyBC = d->mustApplyBCG_;
+		MPlotSimd::colorLookup(values.size(), values.constData(), 0.0, 1.0, applyBC ? brightness : 0.0, applyBC ? contrast : 1.0, colorArraySize, colorArray.constData(), colorArraySize, output);
 	}
 
 	return true;
@@ -458,22 +378,8 @@ bool MPlotColorMap::rgbValues(const QVector<int> &values, QRgb *output)
 	if (d->recomputeCachedColorsRequired_)
 		d->recomputeCachedColors();
 
-	int lastColorArrayIndex = d->colorArray_.size() - 1;
 	QVector<QRgb> colorArray = d->colorArray_;
-	int colorArraySize = colorArray.size();
-
-	for (int i = 0, size = values.size(); i < size; i++){
-
-		int index = values.at(i);
-
-		if (index < 0)
-			index = 0;
-
-		else if (index >= colorArraySize)
-			index = lastColorArrayIndex;
-
-		output[i] = colorArray.at(index);
-	}
+	MPlotSimd::colorLookup(values.size(), values.constData(), colorArray.constData(), colorArray.size(), output);
 
 	return true;
 }
@@ -483,6 +389,7 @@ void MPlotColorMap::setBrightness(qreal brightness)
 	d.detach();
 	d->brightness_ = brightness;
 	d->mustApplyBCG_ = !(d->brightness_ == 0.0 && d->contrast_ == 1.0 && d->gamma_ == 1.0);
+	d->recomputeTransferTable();
 }
 
 void MPlotColorMap::setContrast(qreal contrast)
@@ -490,6 +397,7 @@ void MPlotColorMap::setContrast(qreal contrast)
 	d.detach();
 	d->contrast_ = contrast;
 	d->mustApplyBCG_ = !(d->brightness_ == 0.0 && d->contrast_ == 1.0 && d->gamma_ == 1.0);
+	d->recomputeTransferTable();
 }
 
 void MPlotColorMap::setGamma(qreal gamma)
@@ -497,6 +405,75 @@ void MPlotColorMap::setGamma(qreal gamma)
 	d.detach();
 	d->gamma_ = gamma;
 	d->mustApplyBCG_ = !(d->brightness_ == 0.0 && d->contrast_ == 1.0 && d->gamma_ == 1.0);
+	d->recomputeTransferTable();
+}
+
+void MPlotColorMapData::recomputeTransferTable()
+{
+	// Without gamma, the brightness and contrast are cheap enough to apply directly.
+	if (!mustApplyBCG_ || gamma_ == 1.0){
+
+		transferTable_.clear();
+		transferError_.clear();
+		return;
+	}
+
+	transferTable_.resize(MPLOT_COLORMAP_TRANSFER_RESOLUTION+1);
+	transferError_.resize(MPLOT_COLORMAP_TRANSFER_RESOLUTION);
+
+	for (int i = 0; i <= MPLOT_COLORMAP_TRANSFER_RESOLUTION; i++)
+		transferTable_[i] = contrast_*(pow(qreal(i)/MPLOT_COLORMAP_TRANSFER_RESOLUTION, gamma_) + brightness_);
+
+	// pow() is close to a parabola over one step (except the first one, which rgbValuesFromTransferTable() always computes exactly), so the error is largest in the middle.
+	for (int i = 0; i < MPLOT_COLORMAP_TRANSFER_RESOLUTION; i++){
+
+		qreal exact = contrast_*(pow((qreal(i)+0.5)/MPLOT_COLORMAP_TRANSFER_RESOLUTION, gamma_) + brightness_);
+		transferError_[i] = qAbs(exact - (transferTable_.at(i)+transferTable_.at(i+1))/2);
+	}
+}
+
+void MPlotColorMap::rgbValuesFromTransferTable(const qreal *values, int size, qreal minimum, qreal range, qreal scale, QRgb *output) const
+{
+	const qreal *table = d->transferTable_.constData();
+	const qreal *errors = d->transferError_.constData();
+	const qreal steps = MPLOT_COLORMAP_TRANSFER_RESOLUTION;
+	// Interpolating is accurate enough while the error stays under 1/32 of a color step.  (Finer color maps need more exact values.)
+	const qreal errorLimit = scale != 0 ? 1.0/(32*qAbs(scale)) : 1.0;
+	const int chunkSize = 1024;
+	qreal transferred[chunkSize];
+
+	for (int start = 0; start < size; start += chunkSize){
+
+		int n = qMin(chunkSize, size-start);
+
+		for (int i = 0; i < n; i++){
+
+			qreal position = (values[start+i]-minimum)/range*steps;
+
+			// NaN stays NaN, which gets the first color.
+			if (position != position)
+				transferred[i] = position;
+
+			else {
+
+				if (position < 0)
+					position = 0;
+
+				else if (position > steps)
+					position = steps;
+
+				int step = qMin(int(position), MPLOT_COLORMAP_TRANSFER_RESOLUTION-1);
+
+				// pow() is too steep to interpolate in the first step when gamma < 1, and in the steps where the table isn't fine enough for this resolution.
+				if (step == 0 || errors[step] > errorLimit)
+					transferred[i] = d->contrast_*(pow(position/steps, d->gamma_) + d->brightness_);
+				else
+					transferred[i] = table[step] + (table[step+1]-table[step])*(position-step);
+			}
+		}
+
+		MPlotSimd::colorLookup(n, transferred, 0.0, 1.0, 0.0, 1.0, scale, d->colorArray_.constData(), d->colorArray_.size(), output+start);
+	}
 }
 
 bool MPlotColorMap::operator !=(const MPlotColorMap &other) const
@@ -15,6 +15,9 @@
 
 #include <QSharedData>
 
+/// The number of steps in the brightness/contrast/gamma transfer table used by MPlotColorMap::rgbValues() (see MPlotColorMapData::transferTable_).  Values are interpolated linearly between steps, except in the steps where that wouldn't be accurate enough for the color map's resolution (see MPlotColorMapData::transferError_).
+#define MPLOT_COLORMAP_TRANSFER_RESOLUTION 4096
+
 /// This private class is used to implement implicit sharing for MPlotColorMap
 class MPlotColorMapData : public QSharedData
 {
@@ -50,6 +53,13 @@ class MPlotColorMapData : public QSharedData
 	qreal brightness_, contrast_, gamma_;
 	/// Optimization flag to indicate if brightness, contrast, and gamma corrections need to be applied
 	qreal mustApplyBCG_;
+	/// When gamma is applied: contrast*(pow(t, gamma) + brightness) for MPLOT_COLORMAP_TRANSFER_RESOLUTION+1 evenly spaced values of t from 0 to 1, so that rgbValues() doesn't call pow() for every value.  Empty otherwise.
+	QVector<qreal> transferTable_;
+	/// For each step of transferTable_: how far linear interpolation is from the exact value, measured in the middle of the step.  Values in steps where this is more than 1/32 of a color step are computed with pow() instead.
+	QVector<qreal> transferError_;
+
+	/// Helper function to re-build transferTable_ when the brightness, contrast, or gamma change.
+	void recomputeTransferTable();
 
 
 	/// Helper function to recompute the cached color array when the color stops, resolution, or blend mode are changed.  It will be called automatically as required, but you can also call it prior to calling colorAt() or rgbAt() if you want to optimize the timing of when the cached color map is calculated.
@@ -104,6 +114,10 @@ You can retrieve the color corresponding to a given value in three ways:
 
 Equivalent versions of these functions are provided that return a QRgb instead of a  QColor, for maximum performance.
 
+<b>Brightness, contrast and gamma</b>
+
+setBrightness(), setContrast() and setGamma() change how a normalized value t (from 0 to 1) picks its color: contrast*(pow(t, gamma) + brightness) is used instead of t.  Values outside the range are clamped to t = 0 or t = 1 first, so they always get the same color as the ends of the range, for every setting.  (Before, they were only clamped after the correction, so with a contrast below 1, values far outside the range could get colors from the middle of the map; and with gamma, values below the range had no defined color.)  This applies to rgbAt(), colorAt(), and rgbValues().
+
 <b>Copy-on-write</b>
 This class is intended to be passed value, in the same way that QColor and QGradient are passed by value.  It exploits the implicit sharing ("copy-on-write") strategy provided by all of Qt's container classes so that it can be copied very quickly.
 */
@@ -145,6 +159,12 @@ public:
 	QRgb rgbAt(qreal value) const
 	{
 		if(d->mustApplyBCG_) {
+			// Out-of-range values get the end colors, whatever the correction.
+			if(value < 0.0)
+				value = 0.0;
+			else if(value > 1.0)
+				value = 1.0;
+
 			if(d->gamma_ == 1.0)
 				value = d->contrast_ * (value + d->brightness_);
 			else
@@ -165,7 +185,7 @@ public:
 		return d->colorArray_.at(index);
 	}
 
-	/// Values implementation for returning QRgb values.  The method requires a list of values that need to be converted, the range, and the pointer to the list of QRgb's you want the results saved to.  Returns true if successful.  \param output needs to be properly allocated before being passed in.
+	/// Values implementation for returning QRgb values.  The method requires a list of values that need to be converted, the range, and the pointer to the list of QRgb's you want the results saved to.  Values outside the range get the end colors, with or without brightness, contrast and gamma.  Returns true if successful.  \param output needs to be properly allocated before being passed in.
 	bool rgbValues(const QVector<qreal> &values, MPlotRange range, QRgb *output);
 	/// Values implementation for returning QRgb values.  The method requires a list of values between 0 and 1 and the pointer to the list of QRgb values.  \param output needs to be properly allocated before being passed in.
 	bool rgbValues(const QVector<qreal> &values, QRgb *output);
@@ -234,6 +254,10 @@ public:
 protected:
 
 private:
+	/// Used by rgbValues() when gamma is applied: looks up each of the \c size values in the transfer table, after normalizing it with (value - \c minimum)/\c range, and then maps the result to a color index by multiplying with \c scale.  Values outside the range are treated as the ends of the range.
+	/*! At any resolution(), the color index differs from the one computed with pow() by at most one step, and only for values within about 1/32 of a step of the boundary between two colors: steps of the table where interpolating would be less accurate than that are computed with pow().  The higher the resolution, the more values that takes (ex: with gamma 0.1, about 0.2% of them at 256 colors and 3% at 65536 colors).
+	  */
+	void rgbValuesFromTransferTable(const qreal* values, int size, qreal minimum, qreal range, qreal scale, QRgb* output) const;
 
 	/// To implement implicit sharing:
 	QExplicitlySharedDataPointer<MPlotColorMapData> d;
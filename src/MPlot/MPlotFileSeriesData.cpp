@@ -0,0 +1,331 @@
+#ifndef __MPlotFileSeriesData_CPP__
+#define __MPlotFileSeriesData_CPP__
+
+#include "MPlot/MPlotFileSeriesData.h"
+
+#include <QDebug>
+
+#include <math.h>
+#include <string.h>
+#include <limits>
+
+/// Converts \c n values of type T, starting at \c start and \c stride values apart, into \c outputValues.
+template<class T>
+static void convertValues(const uchar* start, int stride, int n, qreal* outputValues)
+{
+	// memcpy() instead of a cast, since the values in the file might not be aligned.  Compilers turn it into a plain load.
+	const qint64 step = qint64(stride)*qint64(sizeof(T));
+	for(int i = 0; i < n; ++i) {
+		T value;
+		memcpy(&value, start + i*step, sizeof(T));
+		outputValues[i] = qreal(value);
+	}
+}
+
+MPlotFileSeriesData::MPlotFileSeriesData()
+{
+	data_ = 0;
+	mappedSize_ = 0;
+	dataType_ = Float64;
+	layout_ = Interleaved;
+	headerSize_ = 0;
+	xStart_ = 0;
+	xStep_ = 1;
+	count_ = 0;
+}
+
+MPlotFileSeriesData::~MPlotFileSeriesData()
+{
+	unmapFile();
+	file_.close();
+}
+
+bool MPlotFileSeriesData::open(const QString &fileName, DataType dataType, Layout layout, qint64 headerSize)
+{
+	unmapFile();
+	file_.close();
+
+	dataType_ = dataType;
+	layout_ = layout;
+	headerSize_ = qMax(qint64(0), headerSize);
+
+	file_.setFileName(fileName);
+	if(!file_.open(QIODevice::ReadOnly)) {
+		qWarning() << "MPlotFileSeriesData: Could not open" << fileName << ":" << file_.errorString();
+		emitDataChanged();
+		return false;
+	}
+
+	if(!mapFile()) {
+		file_.close();
+		emitDataChanged();
+		return false;
+	}
+
+	emitDataChanged();
+	return true;
+}
+
+void MPlotFileSeriesData::close()
+{
+	if(!file_.isOpen())
+		return;
+
+	unmapFile();
+	file_.close();
+	emitDataChanged();
+}
+
+bool MPlotFileSeriesData::refresh()
+{
+	if(!file_.isOpen())
+		return false;
+
+	int oldCount = count_;
+	if(!mapFile() || count_ == oldCount)
+		return false;
+
+	// In a planar file, the y-values start after all the x-values, so they all move when the file grows.
+	if(count_ > oldCount && layout_ != Planar)
+		emitDataAppended(count_ - oldCount);
+	else
+		emitDataChanged();
+	return true;
+}
+
+void MPlotFileSeriesData::setImplicitX(qreal start, qreal step)
+{
+	xStart_ = start;
+	xStep_ = step;
+
+	if(layout_ == ImplicitX && count_ > 0)
+		emitDataChanged();
+}
+
+int MPlotFileSeriesData::dataTypeSize(DataType dataType)
+{
+	switch(dataType) {
+	case Int8:
+	case UInt8:
+		return 1;
+	case Int16:
+	case UInt16:
+		return 2;
+	case Int32:
+	case UInt32:
+	case Float32:
+		return 4;
+	case Float64:
+		return 8;
+	}
+	return 1;
+}
+
+qreal MPlotFileSeriesData::x(unsigned index) const
+{
+	if(layout_ == ImplicitX)
+		return xStart_ + qreal(index)*xStep_;
+
+	int stride;
+	qint64 element = xElement(int(index), stride);
+	qreal value;
+	readValues(element, stride, 1, &value);
+	return value;
+}
+
+void MPlotFileSeriesData::xValues(unsigned indexStart, unsigned indexEnd, qreal *outputValues) const
+{
+	int n = int(indexEnd) - int(indexStart) + 1;
+
+	if(layout_ == ImplicitX) {
+		for(int i = 0; i < n; ++i)
+			outputValues[i] = xStart_ + qreal(indexStart + unsigned(i))*xStep_;
+		return;
+	}
+
+	int stride;
+	qint64 element = xElement(int(indexStart), stride);
+	readValues(element, stride, n, outputValues);
+}
+
+qreal MPlotFileSeriesData::y(unsigned index) const
+{
+	int stride;
+	qint64 element = yElement(int(index), stride);
+	qreal value;
+	readValues(element, stride, 1, &value);
+	return value;
+}
+
+void MPlotFileSeriesData::yValues(unsigned indexStart, unsigned indexEnd, qreal *outputValues) const
+{
+	int stride;
+	qint64 element = yElement(int(indexStart), stride);
+	readValues(element, stride, int(indexEnd) - int(indexStart) + 1, outputValues);
+}
+
+MPlotDataSpan MPlotFileSeriesData::xSpan(unsigned indexStart, unsigned /*indexEnd*/) const
+{
+	if(layout_ == ImplicitX)
+		return MPlotDataSpan();
+
+	int stride;
+	qint64 element = xElement(int(indexStart), stride);
+	return directSpan(element, stride);
+}
+
+MPlotDataSpan MPlotFileSeriesData::ySpan(unsigned indexStart, unsigned /*indexEnd*/) const
+{
+	int stride;
+	qint64 element = yElement(int(indexStart), stride);
+	return directSpan(element, stride);
+}
+
+bool MPlotFileSeriesData::indexRangeForX(qreal xMin, qreal xMax, int &firstIndex, int &lastIndex) const
+{
+	if(layout_ != ImplicitX || !(xStep_ > 0))
+		return MPlotAbstractSeriesData::indexRangeForX(xMin, xMax, firstIndex, lastIndex);
+
+	if(xMin != xMin || xMax != xMax)
+		return false;
+
+	// Solve for the indexes directly.  (Clamped before converting to int, since the range can be far outside the data.)
+	int first = int(qBound(qreal(0), qreal(ceil((xMin - xStart_)/xStep_)), qreal(count_)));
+	int last = int(qBound(qreal(-1), qreal(floor((xMax - xStart_)/xStep_)), qreal(count_-1)));
+
+	// Rounding can put the answer off by one; fix it up with the actual x-values.
+	while(first > 0 && x(unsigned(first-1)) >= xMin)
+		first--;
+	while(first < count_ && x(unsigned(first)) < xMin)
+		first++;
+	while(last < count_-1 && x(unsigned(last+1)) <= xMax)
+		last++;
+	while(last >= 0 && x(unsigned(last)) > xMax)
+		last--;
+
+	if(last < first)
+		last = first-1;
+
+	firstIndex = first;
+	lastIndex = last;
+	return true;
+}
+
+bool MPlotFileSeriesData::mapFile()
+{
+	qint64 pointSize = qint64(valuesPerPoint())*dataTypeSize(dataType_);
+	qint64 available = file_.size() - headerSize_;
+	qint64 points = available > 0 ? available/pointSize : 0;
+	if(points > std::numeric_limits<int>::max()) {
+		qWarning() << "MPlotFileSeriesData: Only the first" << std::numeric_limits<int>::max() << "points of" << file_.fileName() << "can be plotted.";
+		points = std::numeric_limits<int>::max();
+	}
+
+	qint64 size = points*pointSize;
+	if(size == mappedSize_)
+		return true;
+
+	// Map the new size before dropping the old mapping, so the model stays usable if this fails.
+	uchar* data = 0;
+	if(size > 0) {
+		data = file_.map(headerSize_, size);
+		if(!data) {
+			qWarning() << "MPlotFileSeriesData: Could not map" << file_.fileName() << ":" << file_.errorString();
+			return false;
+		}
+	}
+
+	unmapFile();
+	data_ = data;
+	mappedSize_ = size;
+	count_ = int(points);
+	return true;
+}
+
+void MPlotFileSeriesData::unmapFile()
+{
+	if(data_)
+		file_.unmap(data_);
+
+	data_ = 0;
+	mappedSize_ = 0;
+	count_ = 0;
+}
+
+qint64 MPlotFileSeriesData::xElement(int index, int &stride) const
+{
+	if(layout_ == Interleaved) {
+		stride = 2;
+		return 2*qint64(index);
+	}
+
+	stride = 1;
+	return index;
+}
+
+qint64 MPlotFileSeriesData::yElement(int index, int &stride) const
+{
+	switch(layout_) {
+	case Interleaved:
+		stride = 2;
+		return 2*qint64(index) + 1;
+	case Planar:
+		stride = 1;
+		return qint64(count_) + index;
+	case ImplicitX:
+		break;
+	}
+
+	stride = 1;
+	return index;
+}
+
+void MPlotFileSeriesData::readValues(qint64 element, int stride, int n, qreal *outputValues) const
+{
+	if(n <= 0)
+		return;
+
+	const uchar* start = data_ + element*dataTypeSize(dataType_);
+
+	switch(dataType_) {
+	case Int8:
+		convertValues<qint8>(start, stride, n, outputValues);
+		break;
+	case UInt8:
+		convertValues<quint8>(start, stride, n, outputValues);
+		break;
+	case Int16:
+		convertValues<qint16>(start, stride, n, outputValues);
+		break;
+	case UInt16:
+		convertValues<quint16>(start, stride, n, outputValues);
+		break;
+	case Int32:
+		convertValues<qint32>(start, stride, n, outputValues);
+		break;
+	case UInt32:
+		convertValues<quint32>(start, stride, n, outputValues);
+		break;
+	case Float32:
+		convertValues<float>(start, stride, n, outputValues);
+		break;
+	case Float64:
+		convertValues<double>(start, stride, n, outputValues);
+		break;
+	}
+}
+
+MPlotDataSpan MPlotFileSeriesData::directSpan(qint64 element, int stride) const
+{
+	// Only doubles can be used in place, and only when qreal is double, and the file puts them on an aligned address.
+	if(!data_ || dataType_ != Float64 || sizeof(qreal) != sizeof(double))
+		return MPlotDataSpan();
+
+	const uchar* start = data_ + element*qint64(sizeof(double));
+	if(quintptr(start) % sizeof(double))
+		return MPlotDataSpan();
+
+	return MPlotDataSpan(reinterpret_cast<const qreal*>(start), stride);
+}
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef MPLOTFILESERIESDATA_H
+#define MPLOTFILESERIESDATA_H
+
+#include "MPlot/MPlot_global.h"
+#include "MPlot/MPlotSeriesData.h"
+
+#include <QFile>
+#include <QString>
+
+/// Series data read straight from a binary file, through a memory mapping, so that files larger than RAM can be plotted without loading them first.
+/*! The file holds raw values of one dataType() in the machine's native byte order, after an optional header of headerSize() bytes, which is skipped.  The values can be laid out as:
+
+  - Interleaved: x0, y0, x1, y1, ...
+  - Planar: all the x-values, then all the y-values.  (The number of points is half the number of values.)
+  - ImplicitX: only the y-values are stored, and x-value \c i is implicitXStart() + i*implicitXStep().
+
+  The operating system pages the values in as they are read, and can drop them again under memory pressure, so memory use stays small no matter how big the file is.  For very large files, enable setLevelOfDetailEnabled() so that drawing only reads the pages it needs, and stays proportional to the number of pixel columns.  (On 32-bit systems, the whole file still needs to fit in the address space.)
+
+  Files that are still being written (ex: by an acquisition program) can be followed by calling refresh() periodically, or when QFileSystemWatcher::fileChanged() is emitted: new complete points are added, and the views are notified that they were appended.  A partial point at the end of the file is ignored until it is complete.
+  */
+class MPLOTSHARED_EXPORT MPlotFileSeriesData : public MPlotAbstractSeriesData {
+
+public:
+	/// The type of the values stored in the file.
+	enum DataType { Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64 };
+	/// How the x- and y-values are arranged in the file.
+	enum Layout { Interleaved, Planar, ImplicitX };
+
+	/// Constructs an empty model.  Call open() to read a file.
+	MPlotFileSeriesData();
+	/// Destructor.  Unmaps and closes the file.
+	virtual ~MPlotFileSeriesData();
+
+	/// Opens and maps \c fileName, holding values of type \c dataType arranged as \c layout, after a header of \c headerSize bytes.  Returns false (and leaves the model empty) if the file can't be opened or mapped.
+	bool open(const QString& fileName, DataType dataType, Layout layout = Interleaved, qint64 headerSize = 0);
+	/// Unmaps and closes the file.  The model becomes empty.
+	void close();
+	/// Returns true if a file is open.
+	bool isOpen() const { return file_.isOpen(); }
+
+	/// Re-reads the size of the file, and maps any points added since the last time.  Returns true if the number of points changed.
+	/*! When the file grows, the views are notified that points were appended (except for Planar files, where the y-values move when the file grows, so everything changes).  If the file shrank, everything changes. */
+	bool refresh();
+
+	/// Returns the name of the file that's open.
+	QString fileName() const { return file_.fileName(); }
+	/// Returns the type of the values in the file.
+	DataType dataType() const { return dataType_; }
+	/// Returns how the values are arranged in the file.
+	Layout layout() const { return layout_; }
+	/// Returns the number of bytes skipped at the beginning of the file.
+	qint64 headerSize() const { return headerSize_; }
+
+	/// Sets the x-values used with the ImplicitX layout: x-value \c i is \c start + i*\c step.
+	void setImplicitX(qreal start, qreal step);
+	/// Returns the first x-value used with the ImplicitX layout.
+	qreal implicitXStart() const { return xStart_; }
+	/// Returns the spacing between x-values used with the ImplicitX layout.
+	qreal implicitXStep() const { return xStep_; }
+
+	/// Returns the size of one value of type \c dataType, in bytes.
+	static int dataTypeSize(DataType dataType);
+
+	/// Implements MPlotAbstractSeriesData: returns the x-value at \c index.
+	virtual qreal x(unsigned index) const;
+	/// Converts the x-values from \c indexStart to \c indexEnd (inclusive) to qreal, into \c outputValues.
+	virtual void xValues(unsigned indexStart, unsigned indexEnd, qreal* outputValues) const;
+	/// Implements MPlotAbstractSeriesData: returns the y-value at \c index.
+	virtual qreal y(unsigned index) const;
+	/// Converts the y-values from \c indexStart to \c indexEnd (inclusive) to qreal, into \c outputValues.
+	virtual void yValues(unsigned indexStart, unsigned indexEnd, qreal* outputValues) const;
+	/// Re-implemented to give direct access to the x-values in the mapping, when they are stored as Float64 (and correctly aligned).
+	virtual MPlotDataSpan xSpan(unsigned indexStart, unsigned indexEnd) const;
+	/// Re-implemented to give direct access to the y-values in the mapping, when they are stored as Float64 (and correctly aligned).
+	virtual MPlotDataSpan ySpan(unsigned indexStart, unsigned indexEnd) const;
+
+	/// Implements MPlotAbstractSeriesData: returns the number of complete points in the file.
+	virtual int count() const { return count_; }
+
+	/// Re-implemented to compute the range directly with the ImplicitX layout (when implicitXStep() > 0), in O(1) time.
+	virtual bool indexRangeForX(qreal xMin, qreal xMax, int& firstIndex, int& lastIndex) const;
+
+protected:
+	/// Maps the data part of the file at its current size, and updates count_.  Returns false if the mapping failed.
+	bool mapFile();
+	/// Unmaps the file, if it's mapped.
+	void unmapFile();
+
+	/// Returns the number of values of \c dataType_ stored for each point.
+	int valuesPerPoint() const { return layout_ == ImplicitX ? 1 : 2; }
+	/// Returns the position (in values from the start of the data) of x-value \c index, and the number of values between x-values in \c stride.
+	qint64 xElement(int index, int& stride) const;
+	/// Returns the position (in values from the start of the data) of y-value \c index, and the number of values between y-values in \c stride.
+	qint64 yElement(int index, int& stride) const;
+	/// Converts \c n values, starting at value \c element and taking every \c stride'th value, into \c outputValues.
+	void readValues(qint64 element, int stride, int n, qreal* outputValues) const;
+	/// Returns a span over the values starting at \c element, if they are stored as qreal-compatible doubles; otherwise a null span.
+	MPlotDataSpan directSpan(qint64 element, int stride) const;
+
+	/// The file.
+	QFile file_;
+	/// The start of the data (after the header) in the mapping, or 0 if nothing is mapped.
+	uchar* data_;
+	/// The number of bytes mapped.
+	qint64 mappedSize_;
+
+	DataType dataType_;
+	Layout layout_;
+	qint64 headerSize_;
+	qreal xStart_, xStep_;
+
+	/// The number of complete points mapped.
+	int count_;
+};
+
+#endif // MPLOTFILESERIESDATA_H
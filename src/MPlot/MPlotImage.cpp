@@ -3,6 +3,8 @@
 
 #include "MPlot/MPlotImage.h"
 #include <QPainter>
+#include <QThread>
+#include <QtConcurrentMap>
 
 MPlotImageSignalHandler::MPlotImageSignalHandler(MPlotAbstractImage *parent)
 	: QObject(0) {
@@ -14,9 +16,18 @@ void MPlotImageSignalHandler::onBoundsChanged() {
 }
 
 void MPlotImageSignalHandler::onDataChanged() {
+	// Already handled by onDataRegionChanged()?
+	if(image_->regionChangeHandled_) {
+		image_->regionChangeHandled_ = false;
+		return;
+	}
 	image_->onDataChangedPrivate();
 }
 
+void MPlotImageSignalHandler::onDataRegionChanged(int xStart, int yStart, int xEnd, int yEnd) {
+	image_->onDataRegionChangedPrivate(QRect(QPoint(xStart, yStart), QPoint(xEnd, yEnd)));
+}
+
 MPlotAbstractImage::MPlotAbstractImage()
 	: MPlotItem()
 {
@@ -24,6 +35,9 @@ MPlotAbstractImage::MPlotAbstractImage()
 	signalHandler_ = new MPlotImageSignalHandler(this);
 
 	data_ = 0;
+	deferredBoundsChange_ = false;
+	deferredDataChange_ = false;
+	regionChangeHandled_ = false;
 
 	// Set style defaults:
 	setDefaults();	// override in subclasses for custom appearance
@@ -84,6 +98,7 @@ void MPlotAbstractImage::setModel(const MPlotAbstractImageData* data, bool ownsM
 	// If there's a new valid model:
 	if(data_) {
 		QObject::connect(data_->signalSource(), SIGNAL(dataChanged()), signalHandler_, SLOT(onDataChanged()));
+		QObject::connect(data_->signalSource(), SIGNAL(dataRegionChanged(int,int,int,int)), signalHandler_, SLOT(onDataRegionChanged(int,int,int,int)));
 		QObject::connect(data_->signalSource(), SIGNAL(boundsChanged()), signalHandler_, SLOT(onBoundsChanged()));
 	}
 
@@ -169,15 +184,59 @@ QRectF MPlotAbstractImage::dataRect() const
 
 void MPlotAbstractImage::onBoundsChangedPrivate()
 {
+	if(deferDataChange()) {
+		deferredBoundsChange_ = true;
+		return;
+	}
+
 	onBoundsChanged(data_? data_->boundingRect() : QRectF());
 	emitBoundsChanged();
 }
 
 void MPlotAbstractImage::onDataChangedPrivate()
 {
+	if(deferDataChange()) {
+		deferredDataChange_ = true;
+		deferredRegion_ = QRect();
+		return;
+	}
+
 	onDataChanged();
 }
 
+void MPlotAbstractImage::onDataRegionChangedPrivate(const QRect &region)
+{
+	regionChangeHandled_ = true;
+
+	if(deferDataChange()) {
+		// Once everything has changed, the blocks don't matter any more.
+		if(!deferredDataChange_)
+			deferredRegion_ |= region;
+		return;
+	}
+
+	onDataRegionChanged(region);
+}
+
+void MPlotAbstractImage::flushDeferredDataChange()
+{
+	bool boundsChange = deferredBoundsChange_;
+	bool dataChange = deferredDataChange_;
+	QRect region = deferredRegion_;
+	deferredBoundsChange_ = false;
+	deferredDataChange_ = false;
+	deferredRegion_ = QRect();
+
+	if(boundsChange) {
+		onBoundsChanged(data_? data_->boundingRect() : QRectF());
+		emitBoundsChanged();
+	}
+	if(dataChange)
+		onDataChanged();
+	else if(!region.isEmpty())
+		onDataRegionChanged(region);
+}
+
 void MPlotAbstractImage::setDefaults() {
 
 	map_ = MPlotColorMap::Jet;
@@ -196,9 +255,17 @@ MPlotImageBasic::MPlotImageBasic(const MPlotAbstractImageData* data)
 	  image_(1,1, QImage::Format_ARGB32)
 {
 	imageRefillRequired_ = true;
+	parallelFillEnabled_ = false;
+	colorTableOutOfDate_ = true;
 	setModel(data);
 }
 
+void MPlotImageBasic::setColorMap(const MPlotColorMap &map)
+{
+	colorTableOutOfDate_ = true;
+	MPlotAbstractImage::setColorMap(map);
+}
+
 // Paint: must be implemented in subclass.
 void MPlotImageBasic::paint(QPainter* painter,
 							const QStyleOptionGraphicsItem* option,
@@ -214,8 +281,13 @@ void MPlotImageBasic::paint(QPainter* painter,
 
 	if(data_) {
 
-		if(imageRefillRequired_)
+		// A new color range changes the color of every pixel.
+		if(imageRefillRequired_ || range() != filledRange_)
 			fillImageFromData();
+		else if(!dirtyRegion_.isEmpty()) {
+			fillImageRegion(dirtyRegion_);
+			dirtyRegion_ = QRect();
+		}
 
 		// the MPlotItem implementation of boundingRect() takes our dataRect() and maps it to drawing coordinates... This is where we need to draw into.
 		QRectF destinationRect = MPlotItem::boundingRect();
@@ -286,11 +358,38 @@ void MPlotImageBasic::onDataChanged() {
 
 }
 
+void MPlotImageBasic::onDataRegionChanged(const QRect &region)
+{
+	if (data_){
+
+		MPlotRange range = data_->range();
+
+		if (!manualMinimum_)
+			range_.setX(range.x());
+
+		if (!manualMaximum_)
+			range_.setY(range.y());
+
+		// Only the changed block needs to be re-filled, unless the whole image is already out of date (or is the wrong size).
+		if (!imageRefillRequired_){
+
+			if (image_.size() == data_->size())
+				dirtyRegion_ |= region;
+			else
+				imageRefillRequired_ = true;
+		}
+	}
+
+	update();
+}
+
 void MPlotImageBasic::fillImageFromData() {
 
 	if(data_) {
 
 		imageRefillRequired_ = false;
+		dirtyRegion_ = QRect();
+		filledRange_ = range();
 
 		// resize if req'd:
 		QSize dataSize = data_->size();
@@ -298,29 +397,130 @@ void MPlotImageBasic::fillImageFromData() {
 		if(image_.size() != dataSize)
 			image_ = QImage(dataSize, QImage::Format_ARGB32);
 
-		int yHeight = dataSize.height();
-		int xWidth = dataSize.width();
+		if(dataSize.width() > 0 && dataSize.height() > 0)
+			fillImageRegion(QRect(QPoint(0, 0), dataSize));
+	}
+}
 
-		if(xWidth > 0 && yHeight > 0) {
+void MPlotImageBasic::fillImageRegion(const QRect &region)
+{
+	QRect block = region & QRect(QPoint(0, 0), image_.size());
 
-			QVector<qreal> dataBuffer(xWidth*yHeight);
-			data_->zValues(0, 0, xWidth-1, yHeight-1, dataBuffer.data());
+	if(!data_ || block.isEmpty())
+		return;
 
-			QVector<QRgb> rgbs = QVector<QRgb>(dataBuffer.size());
-			map_.rgbValues(dataBuffer, range(), rgbs.data());
+	// (Detaches image_ here, on this thread, if it's shared.)
+	QRgb *image = (QRgb *)image_.bits();
 
-			QRgb *image = (QRgb *)image_.bits();
-			int heightModifier = (yHeight-1)*xWidth;
+	// Also on this thread: the bands only read the table.
+	updateColorTable();
 
-			for (int xx = 0; xx < xWidth; xx++){
+	int bandHeight = qMax(1, MPLOT_IMAGE_FILL_BAND_PIXELS/block.width());
 
-				int xc = xx*yHeight;
+	if(!parallelFillEnabled_ || bandHeight >= block.height() || QThread::idealThreadCount() < 2){
 
-				for (int yy = 0; yy < yHeight; yy++)
-					image[xx-yy*xWidth+heightModifier] = rgbs.at(xc+yy);
-			}
-		}
+		fillImageBlock(block, image);
+		return;
+	}
+
+	// The color table is computed the first time it's used. Make sure that happens here, rather than on several threads at once.
+	map_.rgbAtIndex(0);
+
+	// Bands of y-values are bands of rows in the image, so they never write the same pixels.
+	QVector<FillBand> bands;
+	bands.reserve((block.height()+bandHeight-1)/bandHeight);
+
+	for (int y = block.top(); y <= block.bottom(); y += bandHeight){
+
+		FillBand band;
+		band.item = this;
+		band.block = QRect(block.left(), y, block.width(), qMin(bandHeight, block.bottom()-y+1));
+		band.image = image;
+		bands << band;
 	}
+
+	QtConcurrent::blockingMap(bands, &MPlotImageBasic::fillImageBand);
+}
+
+void MPlotImageBasic::fillImageBand(FillBand &band)
+{
+	band.item->fillImageBlock(band.block, band.image);
+}
+
+void MPlotImageBasic::fillImageBlock(const QRect &block, QRgb *image) const
+{
+	int blockWidth = block.width();
+	int blockHeight = block.height();
+
+	QVector<QRgb> rgbs = QVector<QRgb>(blockWidth*blockHeight);
+
+	if (!colorTable_.isEmpty()){
+
+		// Small integers: one table lookup per pixel.  (Values are clamped to the table, in case the model has more bits than it says.)
+		QVector<quint16> dataBuffer(blockWidth*blockHeight);
+		data_->zIntegerValues(block.left(), block.top(), block.right(), block.bottom(), dataBuffer.data());
+
+		const QRgb *table = colorTable_.constData();
+		const quint16 *values = dataBuffer.constData();
+		QRgb *output = rgbs.data();
+		int lastEntry = colorTable_.size()-1;
+
+		for (int i = 0, size = dataBuffer.size(); i < size; i++)
+			output[i] = table[qMin(int(values[i]), lastEntry)];
+	}
+
+	else {
+
+		QVector<qreal> dataBuffer(blockWidth*blockHeight);
+		data_->zValues(block.left(), block.top(), block.right(), block.bottom(), dataBuffer.data());
+		colorValues(dataBuffer, rgbs.data());
+	}
+
+	int xWidth = image_.width();
+	int heightModifier = (image_.height()-1)*xWidth;
+
+	for (int xx = 0; xx < blockWidth; xx++){
+
+		int xc = xx*blockHeight;
+		int imageX = block.left()+xx;
+
+		for (int yy = 0; yy < blockHeight; yy++)
+			image[imageX-(block.top()+yy)*xWidth+heightModifier] = rgbs.at(xc+yy);	// note the inversion here. It's necessary because we'll be painting in graphics drawing coordinates.
+	}
+}
+
+void MPlotImageBasic::colorValues(const QVector<qreal> &values, QRgb *output) const
+{
+	// (A copy of the map, since rgbValues() isn't const.  It shares the same color table.)
+	MPlotColorMap map = map_;
+	map.rgbValues(values, range(), output);
+}
+
+void MPlotImageBasic::updateColorTable()
+{
+	int bits = data_ ? data_->zIntegerBits() : 0;
+
+	if (bits <= 0 || bits > 16){
+
+		colorTable_.clear();
+		return;
+	}
+
+	int entries = 1 << bits;
+
+	if (!colorTableOutOfDate_ && colorTable_.size() == entries && colorTableRange_ == range())
+		return;
+
+	// Every possible value goes through the same path as the qreal values, so the colors are identical.
+	QVector<qreal> values(entries);
+
+	for (int i = 0; i < entries; i++)
+		values[i] = qreal(i);
+
+	colorTable_.resize(entries);
+	colorValues(values, colorTable_.data());
+	colorTableRange_ = range();
+	colorTableOutOfDate_ = false;
 }
 
 
@@ -346,47 +546,20 @@ MPlotImageBasicwDefault::MPlotImageBasicwDefault(const MPlotAbstractImageData *d
 	defaultValue_ = 0;
 }
 
-void MPlotImageBasicwDefault::fillImageFromData()
+void MPlotImageBasicwDefault::colorValues(const QVector<qreal> &values, QRgb *output) const
 {
-	if(data_) {
-
-		imageRefillRequired_ = false;
+	MPlotColorMap map = map_;
+	map.rgbValues(values, range_, output);
 
-		// resize if req'd:
-		QSize dataSize = data_->size();
-
-		if(image_.size() != dataSize)
-			image_ = QImage(dataSize, QImage::Format_ARGB32);
-
-		int yHeight = dataSize.height();
-		int xWidth = dataSize.width();
-
-		if(xWidth > 0 && yHeight > 0) {
+	QRgb defaultRgb = defaultColor_.rgb();
 
-			QVector<qreal> dataBuffer(xWidth*yHeight);
-			data_->zValues(0, 0, xWidth-1, yHeight-1, dataBuffer.data());
+	for (int i = 0, size = values.size(); i < size; i++){
 
-			QVector<QRgb> rgbs = QVector<QRgb>(dataBuffer.size());
-			map_.rgbValues(dataBuffer, range_, rgbs.data());
+		double val = values.at(i);
+		bool valid = (val != defaultValue_ && val != -1.0); // NOTE: -1.0 here is from AMNUMBER_INVALID_FLOATINGPOINT
 
-			QRgb *image = (QRgb *)image_.bits();
-			int heightModifier = (yHeight-1)*xWidth;
-			QVector<QRgb> defaultValues = QVector<QRgb>(dataBuffer.size(), defaultColor_.rgb());
-			memcpy(image, defaultValues.constData(), dataBuffer.size()*sizeof(QRgb));
-
-			for (int xx = 0; xx < xWidth; xx++){
-
-				int xc = xx*yHeight;
-
-				for (int yy = 0; yy < yHeight; yy++){
-
-					double val = dataBuffer.at(xc+yy);
-
-					if (val != defaultValue_ && val != -1.0) // NOTE: -1.0 here is from AMNUMBER_INVALID_FLOATINGPOINT
-						image[xx-yy*xWidth+heightModifier] = rgbs.at(xc+yy);// note the inversion here. It's necessary because we'll be painting in graphics drawing coordinates.
-				}
-			}
-		}
+		if (!valid)
+			output[i] = defaultRgb;
 	}
 }
 
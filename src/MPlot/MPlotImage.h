@@ -7,6 +7,8 @@
 #include "MPlot/MPlotColorMap.h"
 #include "MPlot/MPlotItem.h"
 
+/// The number of pixels in each band when MPlotImageBasic re-fills its image on several threads (see MPlotImageBasic::setParallelFillEnabled()).  Big enough to make the hand-off worthwhile, and small enough that one band's values and colors stay in the L2 cache.
+#define MPLOT_IMAGE_FILL_BAND_PIXELS 65536
 
 class MPlotAbstractImage;
 
@@ -23,6 +25,8 @@ protected:
 protected slots:
 		/// Slot that handles updating the data in the the image.
 	void onDataChanged();
+		/// Slot that handles updating a block of the data in the image.
+	void onDataRegionChanged(int xStart, int yStart, int xEnd, int yEnd);
 		/// Slot that handles updating the bounds of the image.
 	void onBoundsChanged();
 
@@ -85,12 +89,17 @@ public:
 	/// Data rect: reported in actual data coordinates. This is used by the auto-scaling to figure out the range of our data on an axis.
 	virtual QRectF dataRect() const;
 
+	/// Handles the bounds and data changes that were put off while the plot limits its update rate (see MPlot::setMaximumUpdateRate()).
+	virtual void flushDeferredDataChange();
+
 protected:
 	/// Helper function that sets some defaults for the image.
 	virtual void setDefaults();
 
 	/// When the z-data changes, this is called to allow an update:
 	virtual void onDataChanged() = 0;
+	/// When only the z-values in \c region (in data indexes: x is the x-index, y is the y-index) change, this is called instead of onDataChanged().  The default implementation calls onDataChanged().
+	virtual void onDataRegionChanged(const QRect& region) { Q_UNUSED(region) onDataChanged(); }
 	/// When the bounds change, this is called to allow whatever needs to happen for computing a new raster grid, etc.
 	virtual void onBoundsChanged(const QRectF& newBounds) = 0;
 	/// Virtual helper method to help notify that the image needs to be repainted.
@@ -112,6 +121,15 @@ protected:
 	/// The flag that holds whether the image constrains the range to the data.
 	bool constrainToData_;
 
+	/// True if a bounds change is waiting for the next frame.
+	bool deferredBoundsChange_;
+	/// True if a data change is waiting for the next frame.
+	bool deferredDataChange_;
+	/// The block of z-values changed since the last frame, if only blocks were reported (see MPlotImageDataSignalSource::dataRegionChanged()).  Empty if none.
+	QRect deferredRegion_;
+	/// True when the model's dataRegionChanged() was handled, so the dataChanged() that follows it can be ignored.
+	bool regionChangeHandled_;
+
 	/// The signal hander for the image.
 	MPlotImageSignalHandler* signalHandler_;
 	/// Friending the image handler so it has access to its methods.
@@ -122,6 +140,8 @@ private:
 	void onBoundsChangedPrivate();
 	/// Called within the base class to handle the data changed signal from the signal hander.
 	void onDataChangedPrivate();
+	/// Called within the base class to handle the data region changed signal from the signal handler.
+	void onDataRegionChangedPrivate(const QRect& region);
 
 };
 
@@ -139,10 +159,20 @@ public:
 	/// boundingRect: using parent implementation, but adding extra room on edges for our selection highlight.
 	virtual QRectF boundingRect() const;
 
+	/// Returns true if large images are re-filled on several threads.
+	bool parallelFillEnabled() const { return parallelFillEnabled_; }
+	/// Enables or disables re-filling large images on several threads.  The image is split into bands of rows (MPLOT_IMAGE_FILL_BAND_PIXELS pixels each), and each band's values are fetched, colored and stored on the global QThreadPool; the result is identical to filling on one thread.  The model's zValues() must then be safe to call from several threads at once, which is the case for MPlotSimpleImageData.  Disabled by default.
+	void setParallelFillEnabled(bool enabled) { parallelFillEnabled_ = enabled; }
+
+	/// Re-implemented to re-build the color table for integer models (see updateColorTable()) at the next fill.
+	virtual void setColorMap(const MPlotColorMap& map);
+
 
 protected:	// "slots"
 	/// Called when the z-data changes, so that the plot needs to be updated. This fills the pixmap buffer
 	virtual void onDataChanged();
+	/// Called when only the z-values in \c region change.  Only that block of image_ is re-filled at the next paint, as long as the color range stays the same.
+	virtual void onDataRegionChanged(const QRect& region);
 
 	/// If the bounds of the data change (in x- and y-) this might require re-auto-scaling of a plot.
 	virtual void onBoundsChanged(const QRectF& newBounds);
@@ -156,9 +186,41 @@ protected:
 
 	/// indicates that the data has changed, and that the image_ cache is out of date. re-filling the image_ from the data is necessary before redrawing
 	bool imageRefillRequired_;
+	/// The block of image_ (in data indexes) that's out of date, when the rest of it is still good.  Empty if none.
+	QRect dirtyRegion_;
+	/// The color range that image_ was filled with.  If range() changes, all the colors change, and the whole image must be re-filled.
+	MPlotRange filledRange_;
 
 	/// helper function to fill image_ based on the data
 	virtual void fillImageFromData();
+	/// Re-fetches and re-colors the z-values in \c region (in data indexes) into image_.  image_ must already be the size of the data.  Large regions are split into bands filled on several threads, if parallelFillEnabled().
+	virtual void fillImageRegion(const QRect& region);
+	/// Fetches, colors and stores the z-values in \c block (in data indexes, inside image_) into \c image, the pixels of image_.  Can be called on worker threads, for separate blocks at the same time, so it must not change anything else.  If the model stores small integers (see MPlotAbstractImageData::zIntegerBits()), each pixel is colored with one lookup in colorTable_.
+	virtual void fillImageBlock(const QRect& block, QRgb* image) const;
+	/// Colors \c values into \c output.  Used for the z-values of each block, and to build the color table for integer models, so that both give the same colors.
+	virtual void colorValues(const QVector<qreal>& values, QRgb* output) const;
+
+	/// Builds colorTable_ when the model stores small integers: the color of every possible value, from 0 to 2^bits-1.  Only re-built when the color range, the color map, or the number of bits changes.  Otherwise clears it.
+	void updateColorTable();
+
+	/// One band of the image, filled by fillImageBand() on a worker thread.
+	struct FillBand {
+		const MPlotImageBasic* item;
+		QRect block;
+		QRgb* image;
+	};
+	/// Fills one band.  Used with QtConcurrent::blockingMap().
+	static void fillImageBand(FillBand& band);
+
+	/// True if large images are re-filled on several threads.
+	bool parallelFillEnabled_;
+
+	/// The color of every possible z-value, when the model stores small integers.  Empty otherwise.
+	QVector<QRgb> colorTable_;
+	/// The color range that colorTable_ was built for.
+	MPlotRange colorTableRange_;
+	/// True when the colors have changed for some other reason than the range (ex: a new color map), and colorTable_ must be re-built.
+	bool colorTableOutOfDate_;
 };
 
 /// This class is a simple extension to MPlotImageBasic where you can define a colour for pixels that are invalid (ie: not range.min <= z <= range.max).  The default is white, but can be customized.
@@ -178,17 +240,17 @@ public:
 	MPlotImageBasicwDefault(const MPlotAbstractImageData *data = 0, QColor defaultImageColor = Qt::white);
 
 	/// Sets the default value.  This is the value associated with the default colour.
-	void setDefaultValue(qreal val) { defaultValue_ = val; onDataChanged(); }
+	void setDefaultValue(qreal val) { defaultValue_ = val; colorTableOutOfDate_ = true; onDataChanged(); }
 	/// Returns the default value.
 	qreal defaultValue() const { return defaultValue_; }
 	/// Returns the default colour.
 	QColor defaultColor() const { return defaultColor_; }
 	/// Sets the default color.
-	void setDefaultColor(QColor color) { defaultColor_ = color; onDataChanged(); }
+	void setDefaultColor(QColor color) { defaultColor_ = color; colorTableOutOfDate_ = true; onDataChanged(); }
 
 protected:
-	/// Reimplemented to utilize the default color.  Fills image_ based on the data.
-	virtual void fillImageFromData();
+	/// Reimplemented to utilize the default color for the default value and invalid values.
+	virtual void colorValues(const QVector<qreal>& values, QRgb* output) const;
 
 	/// The default color.
 	QColor defaultColor_;
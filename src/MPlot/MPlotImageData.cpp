@@ -49,7 +49,7 @@ qreal MPlotSimpleImageData::y(int indexY) const
 
 qreal MPlotSimpleImageData::z(int indexX, int indexY) const
 {
-	return z_.at(indexX + indexY*x_.size());
+	return z_.at(indexX*y_.size() + indexY);
 }
 
 QRectF MPlotSimpleImageData::boundingRect() const
@@ -79,8 +79,8 @@ void MPlotSimpleImageData::setZ(int indexX, int indexY, qreal z)
 			range_.setY(z);
 	}
 
-	z_[indexX + indexY*x_.size()] = z;
-	emitDataChanged();
+	z_[indexX*y_.size() + indexY] = z;
+	emitDataChanged(indexX, indexY, indexX, indexY);
 }
 
 void MPlotSimpleImageData::recomputeBoundingRect()
@@ -154,7 +154,7 @@ void MPlotSimpleImageData::setZValues(int xStart, int yStart, int xEnd, int yEnd
 
 	range_ = MPlotRange(rangeMinimum, rangeMaximum);
 
-	MPlotAbstractImageData::emitDataChanged();
+	MPlotAbstractImageData::emitDataChanged(xStart, yStart, xEnd, yEnd);
 }
 
 // MPlotSimpleImageDatawDefault
@@ -192,7 +192,7 @@ void MPlotSimpleImageDatawDefault::setZValues(int xStart, int yStart, int xEnd,
 
 	range_ = MPlotRange(rangeMinimum, rangeMaximum);
 
-	MPlotAbstractImageData::emitDataChanged();
+	MPlotAbstractImageData::emitDataChanged(xStart, yStart, xEnd, yEnd);
 }
 
 void MPlotSimpleImageDatawDefault::setZ(int indexX, int indexY, qreal z)
@@ -213,7 +213,7 @@ void MPlotSimpleImageDatawDefault::setZ(int indexX, int indexY, qreal z)
 	}
 
 	z_[indexX*y_.size() + indexY] = z;
-	emitDataChanged();
+	emitDataChanged(indexX, indexY, indexX, indexY);
 }
 
 #endif // MPLOTIMAGEDATA_H
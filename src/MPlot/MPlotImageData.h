@@ -6,6 +6,7 @@
 #include <QObject>
 #include <QPoint>
 #include <QPointF>
+#include <QRect>
 #include <QRectF>
 #include <QPair>
 #include <QVector>
@@ -19,6 +20,8 @@ class MPlotAbstractImageData;
 
 /// This class acts as a proxy to emit signals for MPlotAbstractImageData. You can receive the dataChanged() signal by hooking up to MPlotAbstractImage::signalSource().
 /*! To allow classes that implement MPlotAbstractImageData to also inherit QObject, MPlotAbstractImageData does NOT inherit QObject.  However, it still needs a way to emit signals notifying of changes to the data, which is the role of this class.
+
+  dataChanged() is emitted for every change.  When the model can say which block of values changed, dataRegionChanged() is emitted first, so that images can re-color just that block and then ignore the dataChanged() that follows.
   */
 class MPLOTSHARED_EXPORT MPlotImageDataSignalSource : public QObject {
 	Q_OBJECT
@@ -30,6 +33,8 @@ protected:
 	MPlotImageDataSignalSource(MPlotAbstractImageData* parent);
 	/// Emits the data changed signal for the image.
 	void emitDataChanged() { emit dataChanged(); }
+	/// Emits the region changed signal for the image.
+	void emitDataRegionChanged(int xStart, int yStart, int xEnd, int yEnd) { emit dataRegionChanged(xStart, yStart, xEnd, yEnd); }
 	/// Emits the bounds changed signal for the image.
 	void emitBoundsChanged() { emit boundsChanged(); }
 
@@ -41,6 +46,8 @@ protected:
 signals:
 	/// Notifier that the data has changed.
 	void dataChanged();	/// < the z = f(x,y) data has changed
+	/// Notifier that only the z-values from (\c xStart, \c yStart) to (\c xEnd, \c yEnd) (inclusive) have changed.  Always followed by dataChanged().
+	void dataRegionChanged(int xStart, int yStart, int xEnd, int yEnd);
 	/// Notifier that the bounds of the data have changed.
 	void boundsChanged();/// < The limits / bounds of the x-y grid have changed
 };
@@ -69,6 +76,11 @@ public:
 	/// Copy an entire block of z = f(x,y) values from (xStart,yStart) to (xEnd,yEnd) inclusive, into \c outputValues. The data is copied in row-major order, ie: with the x-axis varying the slowest. (Can assume \c outputValues has enough room to hold all the values, that (xStart,yStart) <= (xEnd,yEnd), and that the indexes are not out of range.)
 	virtual void zValues(int xStart, int yStart, int xEnd, int yEnd, qreal* outputValues) const = 0;
 
+	/// Models that store their z-values as unsigned integers of 16 bits or less (ex: 8- or 16-bit camera frames) can return the number of bits here.  Images then fetch the values with zIntegerValues() and color them through a lookup table with one entry per possible value, instead of converting them to qreal.  The default returns 0: the values are only available as qreal.
+	virtual int zIntegerBits() const { return 0; }
+	/// Copy a block of z-values as integers, in the same order as zValues().  Only called when zIntegerBits() is between 1 and 16.
+	virtual void zIntegerValues(int xStart, int yStart, int xEnd, int yEnd, quint16* outputValues) const { Q_UNUSED(xStart) Q_UNUSED(yStart) Q_UNUSED(xEnd) Q_UNUSED(yEnd) Q_UNUSED(outputValues) }
+
 	/// Convenience function overloads:
 	/// Returns the x position for a given point.
 	qreal x(const QPoint& index) const { return x(index.x()); }
@@ -97,6 +109,8 @@ protected:
 
 	/// Implementing classes should call this when their z- data changes in value
 	void emitDataChanged() { signalSource_->emitDataChanged(); }
+	/// Implementing classes can call this instead of emitDataChanged() when only the z-values from (\c xStart, \c yStart) to (\c xEnd, \c yEnd) (inclusive) have changed, so that images only need to re-color that block.
+	void emitDataChanged(int xStart, int yStart, int xEnd, int yEnd) { signalSource_->emitDataRegionChanged(xStart, yStart, xEnd, yEnd); signalSource_->emitDataChanged(); }
 	/// Implementing classes should call this when their x- y- data changes in extent
 	void emitBoundsChanged() { signalSource_->emitBoundsChanged(); }
 
@@ -66,6 +66,14 @@ MPlot* MPlotItem::plot() const {
 	return plot_;
 }
 
+bool MPlotItem::deferDataChange() {
+	if(!plot_ || plot_->maximumUpdateRate() <= 0)
+		return false;
+
+	plot_->scheduleDeferredUpdate(this);
+	return true;
+}
+
 // Bounding rect: reported in our PlotItem coordinates, which are just the actual data coordinates. This is used by the graphics view system to figure out how much we cover/need to redraw.  Subclasses that draw selection borders or markers need to add their size on top of this.
 QRectF MPlotItem::boundingRect() const {
 
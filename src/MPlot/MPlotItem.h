@@ -147,6 +147,9 @@ public:
 	/// returns the plot we are attached to
 	MPlot* plot() const;
 
+	/// Called by the plot once per frame when it limits its update rate (see MPlot::setMaximumUpdateRate()), to handle the data changes that were put off by deferDataChange().  The default implementation does nothing.
+	virtual void flushDeferredDataChange() {}
+
 
 	/// Bounding rect: This is the rectangle enclosing the plot item, in drawing coordinates.  It is used by the graphics view system to figure out how much we cover/need to redraw.  Subclasses that draw selection borders or markers need to add their size on top of this.
 	virtual QRectF boundingRect() const;
@@ -162,6 +165,8 @@ public:
 
 	/// return the active shape where clicking will select this object in the plot. Subclasses can re-implement for more accuracy.
 	virtual QPainterPath shape() const;
+	/// Returns true if \c region (in drawing coordinates) touches this item, so that a click there should select it.  The default implementation checks whether shape() intersects \c region.  Subclasses can re-implement this when they have a faster or more accurate test.
+	virtual bool hitTest(const QRectF& region) { return shape().intersects(region); }
 
 
 	/// signals: The signalSource() will emit boundsChanged() when the extent of this item's x- or y-data might have changed such that a re-autoscale is necessary.  It will emit selectedChanged(bool isSelected) whenever the selection state of this item changes.
@@ -198,6 +203,9 @@ protected:
 	/// called within MPlotItem to forward this signal
 	void emitLegendContentChanged() { signalSource_->emitLegendContentChanged(); }
 
+	/// Subclasses call this when their data changes.  If plot() limits its update rate, this asks the plot to call flushDeferredDataChange() at the next frame and returns true: the subclass should just remember what changed.  Otherwise it returns false, and the change should be handled right away.
+	bool deferDataChange();
+
 	/// Triggered when the axis scale it uses will be changed, affecting its geometry.  You can re-implement this if you need to handle anything in custom subclasses, but call the base class implementation first.  The base class implementation notifies the scene that the geometry of this object (boundingBox) will be changing, and schedules a paint update().
 	virtual void onAxisScaleAboutToChange() {
 		prepareGeometryChange();
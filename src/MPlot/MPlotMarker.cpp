@@ -4,6 +4,11 @@
 
 #include "MPlot/MPlotMarker.h"
 
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QString>
+
 using namespace MPlotMarkerShape;
 
 MPlotAbstractMarker::MPlotAbstractMarker(qreal size, const QPen& pen, const QBrush& brush) :
@@ -198,6 +203,7 @@ MPlotMarkerCombined::~MPlotMarkerCombined() {
 }
 
 void MPlotMarkerCombined::setSize(qreal size) {
+	size_ = size;
 	foreach(MPlotAbstractMarker* element, elements_) {
 		element->setSize(size);
 	}
@@ -278,5 +284,116 @@ MPlotAbstractMarker* MPlotMarker::create(MPlotMarkerShape::Shape type, qreal siz
 	}
 }
 
+// Shared storage for MPlotMarkerSprite
+namespace {
+	struct MPlotMarkerSpriteCache {
+		MPlotMarkerSpriteCache() { cache.setMaxCost(MPLOT_MARKER_SPRITE_CACHE_SIZE); }
+		QMutex mutex;
+		/// Cost is the image size in kilobytes.
+		QCache<QString, QImage> cache;
+	};
+}
+Q_GLOBAL_STATIC(MPlotMarkerSpriteCache, markerSpriteCache)
+
+bool MPlotMarkerSprite::isCacheable(const MPlotAbstractMarker *marker)
+{
+	if(!marker)
+		return false;
+
+	qreal size = marker->size();
+	if(!(size >= 0 && size < 256))
+		return false;
+
+	QPen pen = marker->pen();
+	Qt::BrushStyle penBrushStyle = pen.brush().style();
+	if(penBrushStyle != Qt::SolidPattern && penBrushStyle != Qt::NoBrush)
+		return false;
+	if(!(pen.widthF() < 64))
+		return false;
+
+	Qt::BrushStyle brushStyle = marker->brush().style();
+	return brushStyle == Qt::SolidPattern || brushStyle == Qt::NoBrush;
+}
+
+QImage MPlotMarkerSprite::sprite(MPlotMarkerShape::Shape shape, MPlotAbstractMarker *marker, qreal devicePixelRatio, bool antialiased)
+{
+	if(!isCacheable(marker))
+		return QImage();
+
+	if(!(devicePixelRatio > 0))
+		devicePixelRatio = 1.0;
+
+	QPen pen = marker->pen();
+	QBrush brush = marker->brush();
+	qreal size = marker->size();
+
+	QString key = QString("%1:%2:%3:%4:%5:%6:%7:%8:%9")
+			.arg(int(shape))
+			.arg(size)
+			.arg(pen.color().rgba())
+			.arg(pen.widthF())
+			.arg(int(pen.style()) | int(pen.capStyle()) | int(pen.joinStyle()) | (pen.isCosmetic() ? 0x10000 : 0))
+			.arg(pen.miterLimit())
+			.arg(int(brush.style()))
+			.arg(brush.color().rgba())
+			.arg(QString("%1:%2").arg(devicePixelRatio).arg(antialiased ? 1 : 0));
+
+	// Dashed pens also need their dashes in the key: custom patterns aren't covered by the style.
+	if(pen.style() != Qt::SolidLine && pen.style() != Qt::NoPen) {
+		key += QString(":%1").arg(pen.dashOffset());
+		QVector<qreal> dashes = pen.dashPattern();
+		for(int i = 0, n = dashes.count(); i < n; ++i)
+			key += QString(",%1").arg(dashes.at(i));
+	}
+
+	MPlotMarkerSpriteCache* storage = markerSpriteCache();
+	QMutexLocker locker(&storage->mutex);
+
+	QImage* cached = storage->cache.object(key);
+	if(cached)
+		return *cached;
+
+	// Room for the marker (the triangle reaches 1/sqrt(3) of its size from the center), the pen (with miter joins), and antialiasing:
+	qreal penWidth = qMax(pen.widthF(), qreal(1.0));
+	if(pen.isCosmetic())
+		penWidth /= devicePixelRatio;
+	qreal halfExtent = 0.6*size + pen.miterLimit()*penWidth + 1.0;
+	int halfPixels = int(ceil(halfExtent*devicePixelRatio));
+
+	QImage image(2*halfPixels, 2*halfPixels, QImage::Format_ARGB32_Premultiplied);
+	image.fill(Qt::transparent);
+
+	QPainter painter(&image);
+	painter.setRenderHint(QPainter::Antialiasing, antialiased);
+	painter.scale(devicePixelRatio, devicePixelRatio);
+	painter.translate(halfPixels/devicePixelRatio, halfPixels/devicePixelRatio);
+	painter.setPen(pen);
+	painter.setBrush(brush);
+	marker->paint(&painter);
+	painter.end();
+
+#if QT_VERSION >= 0x050100
+	// Only set this after painting; otherwise QPainter would apply the scaling a second time.
+	image.setDevicePixelRatio(devicePixelRatio);
+#endif
+
+	storage->cache.insert(key, new QImage(image), qMax(1, image.width()*image.height()/256));
+	return image;
+}
+
+void MPlotMarkerSprite::setCacheLimit(int kilobytes)
+{
+	MPlotMarkerSpriteCache* storage = markerSpriteCache();
+	QMutexLocker locker(&storage->mutex);
+	storage->cache.setMaxCost(qMax(0, kilobytes));
+}
+
+void MPlotMarkerSprite::clearCache()
+{
+	MPlotMarkerSpriteCache* storage = markerSpriteCache();
+	QMutexLocker locker(&storage->mutex);
+	storage->cache.clear();
+}
+
 #endif
 
@@ -4,6 +4,7 @@
 #include "MPlot/MPlot_global.h"
 
 #include <QPainter>
+#include <QImage>
 #include <QPolygonF>
 #include <QLineF>
 #include <QList>
@@ -11,6 +12,9 @@
 
 #include <math.h>
 
+/// The default memory limit (in kilobytes) for the cache of pre-rendered marker images. See MPlotMarkerSprite.
+#define MPLOT_MARKER_SPRITE_CACHE_SIZE 2048
+
 /// Marker shape namespace.  Contains all the basic elements which can also be combined with bitwise OR.
 namespace MPlotMarkerShape {
 	enum Shape { None = 0, Square = 1, Circle = 2, Triangle = 4, VerticalBeam = 8, HorizontalBeam = 16, DiagDownLeft = 32, DiagDownRight = 64, DiagDownLeftR = 128, DiagDownRightR = 256, Point = 512, Cross, CrossSquare, CrossCircle, X, XSquare, XCircle, Star, StarSquare, StarCircle, PointSquare, PointCircle };
@@ -237,4 +241,25 @@ public:
 	static MPlotAbstractMarker* create(MPlotMarkerShape::Shape type = MPlotMarkerShape::Square, qreal size = 6, const QPen& pen = QPen(), const QBrush& brush = QBrush());
 };
 
+/// Pre-rendered images ("sprites") of markers, so that drawing many identical markers is just a matter of copying pixels.
+/*! Each sprite is rendered once, with the marker centered in the image, and kept in a shared cache keyed by the marker's shape, size, pen (including its dash pattern), brush, the device pixel ratio, and whether it's antialiased.  Since the key is built from the marker's current properties, changes made through MPlotAbstractMarker::setPen() etc. are picked up automatically.  The cache is protected by a mutex, so sprites can be requested from any thread.
+
+  Only markers drawn with solid (or no) pens and brushes can be cached: patterned and gradient brushes are aligned to the device, not to the marker, so they would look different when painted directly.  Use isCacheable() to check first.  Sprites are drawn at whole device pixels, so they are visually equivalent to painting the marker directly at its fractional position, not pixel-identical.
+  */
+class MPLOTSHARED_EXPORT MPlotMarkerSprite {
+
+public:
+	/// Returns true if \c marker can be drawn with a sprite.
+	static bool isCacheable(const MPlotAbstractMarker* marker);
+
+	/// Returns the sprite for \c marker, which has the given \c shape.  The image is square and (devicePixelRatio * size()) pixels across, plus room for the pen; the marker's center is at the center of the image.  Returns a null image if the marker isn't cacheable.
+	/*! On Qt 5, the image's devicePixelRatio() is set to \c devicePixelRatio.  When drawing it, use a target rectangle of (image width / \c devicePixelRatio) logical pixels so that it also works on Qt 4.*/
+	static QImage sprite(MPlotMarkerShape::Shape shape, MPlotAbstractMarker* marker, qreal devicePixelRatio = 1.0, bool antialiased = true);
+
+	/// Sets the maximum memory used by the sprite cache, in kilobytes. The default is MPLOT_MARKER_SPRITE_CACHE_SIZE.
+	static void setCacheLimit(int kilobytes);
+	/// Removes all sprites from the cache.
+	static void clearCache();
+};
+
 #endif
@@ -0,0 +1,265 @@
+#ifndef __MPlotMinMaxPyramid_CPP__
+#define __MPlotMinMaxPyramid_CPP__
+
+#include "MPlot/MPlotMinMaxPyramid.h"
+#include "MPlot/MPlotSeriesData.h"
+
+#include <limits>
+
+/// The number of points read from the data at once while building the index.
+#define MPLOT_MINMAXPYRAMID_CHUNK_SIZE 4096
+
+MPlotMinMaxPyramid::Range::Range()
+	: min(std::numeric_limits<qreal>::infinity()), max(-std::numeric_limits<qreal>::infinity())
+{
+}
+
+MPlotMinMaxPyramid::MPlotMinMaxPyramid(const MPlotAbstractSeriesData *data, int blockSize)
+{
+	data_ = data;
+	blockSize_ = qMax(2, blockSize);
+	valid_ = false;
+	count_ = 0;
+	offset_ = 0;
+	baseBlock_ = 0;
+	xAscending_ = true;
+	lastX_ = 0;
+}
+
+void MPlotMinMaxPyramid::update()
+{
+	int dataCount = data_->count();
+
+	if(!valid_ || dataCount < count_)
+		rebuild();
+	else if(dataCount > count_)
+		appendFromData(dataCount);
+}
+
+void MPlotMinMaxPyramid::removeFront(int n)
+{
+	if(!valid_ || n <= 0)
+		return;
+
+	// Points we haven't indexed yet are being removed; can't keep track of that.
+	if(n > count_) {
+		valid_ = false;
+		return;
+	}
+
+	count_ -= n;
+	offset_ += n;
+
+	if(count_ == 0) {
+		levels_.clear();
+		offset_ = 0;
+		baseBlock_ = 0;
+		xAscending_ = true;
+		return;
+	}
+
+	// Discard the dropped leaves once they outnumber the live ones.
+	int droppedLeaves = int(offset_/blockSize_ - baseBlock_);
+	if(droppedLeaves > 16 && droppedLeaves > levels_.at(0).count()/2) {
+		levels_[0].remove(0, droppedLeaves);
+		baseBlock_ += droppedLeaves;
+		updateUpperLevels(0, levels_.at(0).count()-1);
+	}
+}
+
+void MPlotMinMaxPyramid::updateRange(int first, int last)
+{
+	if(!valid_)
+		return;
+
+	// Points past count_ haven't been indexed yet; update() will pick them up.
+	first = qMax(0, first);
+	last = qMin(last, count_-1);
+	if(first > last)
+		return;
+
+	// The x-values must still be sorted, at least where they changed.  (If they weren't sorted before, they might be now; start over.)
+	int lo = qMax(0, first-1);
+	int hi = qMin(count_-1, last+1);
+	qreal previous = data_->x(unsigned(lo));
+	bool ascending = xAscending_ && previous == previous;
+	for(int i = lo+1; ascending && i <= hi; ++i) {
+		qreal xi = data_->x(unsigned(i));
+		if(!(xi >= previous))
+			ascending = false;
+		previous = xi;
+	}
+	if(!ascending) {
+		valid_ = false;
+		return;
+	}
+	if(hi == count_-1)
+		lastX_ = data_->x(unsigned(hi));
+
+	// Re-scan the affected leaves.  The first block may be partly removed already; only its remaining points count.
+	int firstLeaf = int((offset_ + first)/blockSize_ - baseBlock_);
+	int lastLeaf = int((offset_ + last)/blockSize_ - baseBlock_);
+	QVector<Range>& leaves = levels_[0];
+	for(int leaf = firstLeaf; leaf <= lastLeaf; ++leaf) {
+		qint64 blockStart = (baseBlock_ + leaf)*blockSize_ - offset_;
+		Range range;
+		scanData(int(qMax(qint64(0), blockStart)), int(qMin(qint64(count_-1), blockStart + blockSize_ - 1)), range);
+		leaves[leaf] = range;
+	}
+
+	updateUpperLevels(firstLeaf, lastLeaf);
+}
+
+void MPlotMinMaxPyramid::yRange(int first, int last, qreal &minY, qreal &maxY) const
+{
+	Range range;
+
+	qint64 firstPosition = offset_ + first;
+	qint64 lastPosition = offset_ + last;
+	// The first and last leaf blocks that are completely inside [first, last]:
+	qint64 firstBlock = (firstPosition + blockSize_ - 1) / blockSize_;
+	qint64 lastBlock = (lastPosition + 1) / blockSize_ - 1;
+
+	if(firstBlock > lastBlock)
+		scanData(first, last, range);
+
+	else {
+		// Partial blocks at the edges:
+		scanData(first, int(firstBlock*blockSize_ - offset_) - 1, range);
+		scanData(int((lastBlock+1)*blockSize_ - offset_), last, range);
+
+		// Full blocks: walk up the pyramid, using only the nodes which are entirely within [p, q].
+		int p = int(firstBlock - baseBlock_);
+		int q = int(lastBlock - baseBlock_);
+		for(int l = 0; p <= q; ++l) {
+			const QVector<Range>& level = levels_.at(l);
+			if(p & 1) {
+				const Range& node = level.at(p++);
+				if(node.min < range.min)
+					range.min = node.min;
+				if(node.max > range.max)
+					range.max = node.max;
+			}
+			if(!(q & 1)) {
+				const Range& node = level.at(q--);
+				if(node.min < range.min)
+					range.min = node.min;
+				if(node.max > range.max)
+					range.max = node.max;
+			}
+			p >>= 1;
+			q >>= 1;
+		}
+	}
+
+	minY = range.min;
+	maxY = range.max;
+}
+
+void MPlotMinMaxPyramid::rebuild()
+{
+	levels_.clear();
+	count_ = 0;
+	offset_ = 0;
+	baseBlock_ = 0;
+	xAscending_ = true;
+	valid_ = true;
+
+	appendFromData(data_->count());
+}
+
+void MPlotMinMaxPyramid::appendFromData(int newCount)
+{
+	if(newCount <= count_)
+		return;
+
+	if(levels_.isEmpty())
+		levels_.append(QVector<Range>());
+
+	QVector<qreal> x = QVector<qreal>(qMin(newCount-count_, MPLOT_MINMAXPYRAMID_CHUNK_SIZE));
+	QVector<qreal> y = QVector<qreal>(x.size());
+
+	int firstChangedLeaf = int((offset_ + count_)/blockSize_ - baseBlock_);
+
+	while(count_ < newCount) {
+
+		int chunkSize = qMin(newCount-count_, MPLOT_MINMAXPYRAMID_CHUNK_SIZE);
+		data_->xValues(unsigned(count_), unsigned(count_+chunkSize-1), x.data());
+		data_->yValues(unsigned(count_), unsigned(count_+chunkSize-1), y.data());
+
+		QVector<Range>& leaves = levels_[0];
+
+		for(int i = 0; i < chunkSize; ++i) {
+
+			qreal xi = x.at(i);
+			if(xi != xi || (count_ > 0 && xi < lastX_))
+				xAscending_ = false;
+			lastX_ = xi;
+
+			int leaf = int((offset_ + count_)/blockSize_ - baseBlock_);
+			if(leaf == leaves.count())
+				leaves.append(Range());
+
+			Range& node = leaves[leaf];
+			qreal yi = y.at(i);
+			if(yi < node.min)
+				node.min = yi;
+			if(yi > node.max)
+				node.max = yi;
+
+			count_++;
+		}
+	}
+
+	updateUpperLevels(firstChangedLeaf, levels_.at(0).count()-1);
+}
+
+void MPlotMinMaxPyramid::updateUpperLevels(int firstLeaf, int lastLeaf)
+{
+	int lo = firstLeaf;
+	int hi = lastLeaf;
+
+	for(int l = 1; levels_.at(l-1).count() > 1; ++l) {
+
+		int childCount = levels_.at(l-1).count();
+
+		if(l == levels_.count())
+			levels_.append(QVector<Range>());
+
+		QVector<Range>& level = levels_[l];
+		level.resize((childCount+1)/2);
+
+		lo >>= 1;
+		hi >>= 1;
+		for(int j = lo; j <= hi; ++j) {
+			Range node = levels_.at(l-1).at(2*j);
+			if(2*j+1 < childCount) {
+				const Range& right = levels_.at(l-1).at(2*j+1);
+				if(right.min < node.min)
+					node.min = right.min;
+				if(right.max > node.max)
+					node.max = right.max;
+			}
+			level[j] = node;
+		}
+	}
+
+	// Drop any levels above the root.
+	int levelCount = 1;
+	while(levelCount < levels_.count() && levels_.at(levelCount-1).count() > 1)
+		levelCount++;
+	levels_.resize(levelCount);
+}
+
+void MPlotMinMaxPyramid::scanData(int first, int last, Range &range) const
+{
+	for(int i = first; i <= last; ++i) {
+		qreal yi = data_->y(unsigned(i));
+		if(yi < range.min)
+			range.min = yi;
+		if(yi > range.max)
+			range.max = yi;
+	}
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef MPLOTMINMAXPYRAMID_H
+#define MPLOTMINMAXPYRAMID_H
+
+#include "MPlot/MPlot_global.h"
+
+#include <QVector>
+
+class MPlotAbstractSeriesData;
+
+/// The default number of points summarized by each leaf of an MPlotMinMaxPyramid.
+#define MPLOT_MINMAXPYRAMID_BLOCK_SIZE 64
+
+/// A multi-resolution (level of detail) index of the y-values of an MPlotAbstractSeriesData, used to find the minimum and maximum y-value over any range of points in O(log n) time.
+/*! The points are grouped into leaf blocks of blockSize() points, and each leaf stores the min and max y-value of its block.  Each level above combines pairs of nodes from the level below, up to a single root.  yRange() answers a query from the O(log n) nodes that exactly cover the full blocks inside the range, and reads the (at most 2*blockSize()) remaining points at the edges directly from the data.
+
+  The pyramid is built once, and then updated incrementally:
+  - Points appended at the end of the data are indexed the next time update() is called, in O(appended + log n).
+  - Points removed from the front are handled by removeFront(), which just shifts the index origin.  Blocks are aligned to absolute point positions, so the (partially-removed) first block is never used as a full block, and is always read directly from the data instead.  Dropped blocks are discarded once they outnumber the remaining ones.
+  - Changed values are handled by updateRange(), which re-computes only the affected leaves and their ancestors.
+  - Any other change requires a full rebuild: call invalidate(), and the next update() will re-scan the data.
+
+  It also keeps track of whether the x-values are sorted in ascending order (isXAscending()), which is required to map pixel columns to index ranges.
+
+  You don't normally need to create this yourself; use MPlotAbstractSeriesData::setLevelOfDetailEnabled() and MPlotAbstractSeriesData::levelOfDetail().
+  */
+class MPLOTSHARED_EXPORT MPlotMinMaxPyramid {
+
+public:
+	/// Constructs an (empty, invalid) pyramid for \c data, with \c blockSize points per leaf.
+	MPlotMinMaxPyramid(const MPlotAbstractSeriesData* data, int blockSize = MPLOT_MINMAXPYRAMID_BLOCK_SIZE);
+
+	/// Returns the number of points summarized by each leaf.
+	int blockSize() const { return blockSize_; }
+	/// Returns the number of points currently indexed.  After update(), this is the same as the data's count().
+	int count() const { return count_; }
+	/// Returns true if the x-values of all the indexed points are in ascending (non-decreasing) order. NaN x-values count as unsorted.
+	bool isXAscending() const { return xAscending_; }
+
+	/// Brings the index up-to-date with the data: re-builds it if it was invalidated, or indexes any points that were appended since the last update.
+	void update();
+	/// Call when the data has changed in a way that can't be handled incrementally.  The next update() will re-build the index from scratch.
+	void invalidate() { valid_ = false; }
+	/// Call when \c n points have been removed from the front of the data.
+	void removeFront(int n);
+	/// Call when the values of the points from \c first to \c last (inclusive) have changed.  Only the leaves covering those points (and the nodes above them) are re-computed, unless the change un-sorts the x-values, in which case the index is invalidated.
+	void updateRange(int first, int last);
+
+	/// Finds the minimum and maximum y-values of the points from \c first to \c last (inclusive).  The indexes must be valid (< count()).  NaN values are ignored; if all the values are NaN, \c minY will be larger than \c maxY.
+	void yRange(int first, int last, qreal& minY, qreal& maxY) const;
+
+protected:
+	/// The min and max y-values of a node in the pyramid.
+	struct Range {
+		Range();
+		qreal min, max;
+	};
+
+	/// Clears the index and re-scans all the points in the data.
+	void rebuild();
+	/// Indexes the points from count_ up to \c newCount-1.
+	void appendFromData(int newCount);
+	/// Re-computes the nodes in all the levels above level 0 which depend on the leaves from \c firstLeaf to \c lastLeaf.  Also resizes the upper levels to fit the number of leaves.
+	void updateUpperLevels(int firstLeaf, int lastLeaf);
+	/// Scans the data directly for the y-range from \c first to \c last (inclusive), and merges it into \c range.
+	void scanData(int first, int last, Range& range) const;
+
+	/// The data we're indexing.
+	const MPlotAbstractSeriesData* data_;
+	/// The number of points per leaf.
+	int blockSize_;
+	/// False if the index must be re-built at the next update().
+	bool valid_;
+	/// The number of points indexed.
+	int count_;
+	/// The absolute position of data point 0.  This increases as points are removed from the front.
+	qint64 offset_;
+	/// The absolute block number of levels_[0][0].
+	qint64 baseBlock_;
+	/// levels_[0] holds the leaves; levels_[l][i] combines levels_[l-1][2i] and levels_[l-1][2i+1].
+	QVector<QVector<Range> > levels_;
+	/// True if the x-values of the indexed points are sorted in ascending order.
+	bool xAscending_;
+	/// The x-value of the last indexed point, used to keep track of xAscending_ as points are appended.
+	qreal lastX_;
+};
+
+#endif // MPLOTMINMAXPYRAMID_H
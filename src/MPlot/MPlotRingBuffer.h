@@ -0,0 +1,120 @@
+#ifndef MPLOTRINGBUFFER_H
+#define MPLOTRINGBUFFER_H
+
+#include "MPlot/MPlot_global.h"
+
+#include <QVector>
+
+#include <string.h>
+
+/// A growable circular buffer with contiguous storage.  It supports constant-time insertion and removal at both ends, and constant-time random access.
+/*! Unlike QQueue (which is a QList), the elements are stored in one contiguous block, in at most two runs: from the head to the end of the storage, and then from the start of the storage up to the tail.  This allows copyValues() to use at most two memcpy() calls.  T must be a type that can be copied with memcpy() (ex: qreal).
+
+  When the buffer is full, append() and prepend() double the storage, so they cost O(1) amortized.  Use reserve() to allocate the storage ahead of time.
+  */
+template<class T>
+class MPlotRingBuffer {
+
+public:
+	/// Constructs an empty buffer, with storage for \c initialCapacity elements.
+	MPlotRingBuffer(int initialCapacity = 0) : buffer_(initialCapacity), head_(0), count_(0) {}
+
+	/// Returns the number of elements in the buffer.
+	int count() const { return count_; }
+	/// Returns true if the buffer holds no elements.
+	bool isEmpty() const { return count_ == 0; }
+	/// Returns the number of elements that can be held before the storage needs to grow.
+	int capacity() const { return buffer_.size(); }
+
+	/// Returns the element at logical \c index (0 is the front).  \c index must be valid.
+	const T& at(int index) const { return buffer_.at(physicalIndex(index)); }
+	/// Returns a modifiable reference to the element at logical \c index.  \c index must be valid.
+	T& operator[](int index) { return buffer_[physicalIndex(index)]; }
+	/// Returns the element at the front.  The buffer must not be empty.
+	const T& first() const { return at(0); }
+	/// Returns the element at the back.  The buffer must not be empty.
+	const T& last() const { return at(count_-1); }
+
+	/// Adds \c value at the back of the buffer.
+	void append(const T& value) {
+		if(count_ == buffer_.size())
+			reserve(qMax(16, 2*buffer_.size()));
+
+		buffer_[physicalIndex(count_)] = value;
+		count_++;
+	}
+
+	/// Adds \c value at the front of the buffer.
+	void prepend(const T& value) {
+		if(count_ == buffer_.size())
+			reserve(qMax(16, 2*buffer_.size()));
+
+		head_ = (head_ == 0 ? buffer_.size() : head_) - 1;
+		buffer_[head_] = value;
+		count_++;
+	}
+
+	/// Removes \c n elements from the front.  \c n must be <= count().
+	void removeFirst(int n = 1) {
+		head_ = physicalIndex(n);
+		count_ -= n;
+		if(count_ == 0)
+			head_ = 0;
+	}
+
+	/// Removes \c n elements from the back.  \c n must be <= count().
+	void removeLast(int n = 1) {
+		count_ -= n;
+		if(count_ == 0)
+			head_ = 0;
+	}
+
+	/// Removes all the elements.  The storage is kept for re-use.
+	void clear() { head_ = 0; count_ = 0; }
+
+	/// Grows the storage to hold at least \c capacity elements.  The contents are unwrapped so that they start at the beginning of the new storage.  Does nothing if \c capacity <= capacity().
+	void reserve(int capacity) {
+		if(capacity <= buffer_.size())
+			return;
+
+		QVector<T> newBuffer(capacity);
+		copyValues(0, count_, newBuffer.data());
+		buffer_ = newBuffer;
+		head_ = 0;
+	}
+
+	/// Returns a pointer to the \c n elements starting at logical \c index, if they are stored in one contiguous run. Returns 0 if they wrap around the end of the storage.
+	const T* constData(int index, int n) const {
+		int start = physicalIndex(index);
+		return start + n <= buffer_.size() ? buffer_.constData()+start : 0;
+	}
+
+	/// Copies \c n elements, starting at logical \c index, into \c output.  This uses at most two memcpy() calls.
+	void copyValues(int index, int n, T* output) const {
+		if(n <= 0)
+			return;
+
+		int start = physicalIndex(index);
+		int firstRun = qMin(n, buffer_.size()-start);
+		memcpy(output, buffer_.constData()+start, firstRun*sizeof(T));
+		if(firstRun < n)
+			memcpy(output+firstRun, buffer_.constData(), (n-firstRun)*sizeof(T));
+	}
+
+protected:
+	/// Maps a logical index (0 is the front) to a position in buffer_.
+	int physicalIndex(int index) const {
+		int position = head_ + index;
+		int size = buffer_.size();
+		return position >= size ? position - size : position;
+	}
+
+	/// The storage.  Its size() is the capacity.
+	QVector<T> buffer_;
+	/// The position in buffer_ of the front element.
+	int head_;
+	/// The number of elements currently held.
+	int count_;
+};
+
+#endif // MPLOTRINGBUFFER_H
@@ -0,0 +1,262 @@
+#ifndef __MPlotSegmentIndex_CPP__
+#define __MPlotSegmentIndex_CPP__
+
+#include "MPlot/MPlotSegmentIndex.h"
+
+#include <qmath.h>
+
+MPlotSegmentIndex::MPlotSegmentIndex()
+{
+	cellSize_ = 1;
+	columns_ = 0;
+	rows_ = 0;
+	visitStamp_ = 0;
+}
+
+void MPlotSegmentIndex::clear()
+{
+	segments_.clear();
+	bounds_ = QRectF();
+	cellSize_ = 1;
+	columns_ = 0;
+	rows_ = 0;
+	cellStart_.clear();
+	cellSegments_.clear();
+	visited_.clear();
+	visitStamp_ = 0;
+}
+
+void MPlotSegmentIndex::build(const QVector<QLineF> &lines, const QVector<QPointF> &polylinePoints, const QVector<int> &polylineLengths)
+{
+	clear();
+
+	segments_.reserve(lines.count() + polylinePoints.count());
+	for(int i = 0, n = lines.count(); i < n; ++i) {
+		const QLineF& line = lines.at(i);
+		if(qIsFinite(line.x1()) && qIsFinite(line.y1()) && qIsFinite(line.x2()) && qIsFinite(line.y2()))
+			segments_ << line;
+	}
+	const QPointF* points = polylinePoints.constData();
+	for(int i = 0, n = polylineLengths.count(); i < n; ++i) {
+		int length = polylineLengths.at(i);
+		for(int j = 1; j < length; ++j) {
+			QLineF line = QLineF(points[j-1], points[j]);
+			if(qIsFinite(line.x1()) && qIsFinite(line.y1()) && qIsFinite(line.x2()) && qIsFinite(line.y2()))
+				segments_ << line;
+		}
+		points += length;
+	}
+
+	int segmentCount = segments_.count();
+	if(segmentCount == 0)
+		return;
+
+	qreal minX = segments_.at(0).x1(), maxX = minX;
+	qreal minY = segments_.at(0).y1(), maxY = minY;
+	for(int i = 0; i < segmentCount; ++i) {
+		const QLineF& line = segments_.at(i);
+		minX = qMin(minX, qMin(line.x1(), line.x2()));
+		maxX = qMax(maxX, qMax(line.x1(), line.x2()));
+		minY = qMin(minY, qMin(line.y1(), line.y2()));
+		maxY = qMax(maxY, qMax(line.y1(), line.y2()));
+	}
+	bounds_ = QRectF(minX, minY, maxX-minX, maxY-minY);
+
+	// Aim for about one cell per segment.  (The second term keeps the grid small when the segments are all on one line.)
+	qreal width = bounds_.width();
+	qreal height = bounds_.height();
+	cellSize_ = qMax(qSqrt(width*height/segmentCount), qMax(width, height)/segmentCount);
+	if(!(cellSize_ > 0))
+		cellSize_ = 1;
+	columns_ = int(width/cellSize_) + 1;
+	rows_ = int(height/cellSize_) + 1;
+
+	// Find the cells of every segment, then sort the segments into the cells by counting.
+	QVector<int> cells;
+	QVector<int> owners;
+	cells.reserve(2*segmentCount);
+	owners.reserve(2*segmentCount);
+	for(int i = 0; i < segmentCount; ++i) {
+		cellsForSegment(segments_.at(i), cells);
+		while(owners.count() < cells.count())
+			owners << i;
+	}
+
+	cellStart_ = QVector<int>(columns_*rows_ + 1, 0);
+	for(int k = 0, n = cells.count(); k < n; ++k)
+		cellStart_[cells.at(k)+1]++;
+	for(int i = 1, n = cellStart_.count(); i < n; ++i)
+		cellStart_[i] += cellStart_.at(i-1);
+
+	QVector<int> next = cellStart_;
+	cellSegments_ = QVector<int>(cells.count());
+	for(int k = 0, n = cells.count(); k < n; ++k)
+		cellSegments_[next[cells.at(k)]++] = owners.at(k);
+
+	visited_ = QVector<quint32>(segmentCount, 0);
+}
+
+int MPlotSegmentIndex::nearestSegment(const QPointF &point, qreal maxDistance, qreal *distance) const
+{
+	if(segments_.isEmpty() || !(maxDistance >= 0))
+		return -1;
+
+	int firstColumn, lastColumn, firstRow, lastRow;
+	if(!cellRange(QRectF(point.x()-maxDistance, point.y()-maxDistance, 2*maxDistance, 2*maxDistance), firstColumn, lastColumn, firstRow, lastRow))
+		return -1;
+
+	quint32 stamp = nextVisitStamp();
+	int best = -1;
+	qreal bestDistance = maxDistance;
+
+	for(int row = firstRow; row <= lastRow; ++row) {
+		for(int column = firstColumn; column <= lastColumn; ++column) {
+			int cell = row*columns_ + column;
+			for(int k = cellStart_.at(cell), end = cellStart_.at(cell+1); k < end; ++k) {
+				int s = cellSegments_.at(k);
+				if(visited_.at(s) == stamp)
+					continue;
+				visited_[s] = stamp;
+
+				qreal d = distanceToSegment(point, segments_.at(s));
+				if(d < bestDistance || (best < 0 && d <= bestDistance)) {
+					best = s;
+					bestDistance = d;
+				}
+			}
+		}
+	}
+
+	if(best >= 0 && distance)
+		*distance = bestDistance;
+	return best;
+}
+
+bool MPlotSegmentIndex::intersects(const QRectF &rect) const
+{
+	if(segments_.isEmpty())
+		return false;
+
+	QRectF area = rect.normalized();
+	int firstColumn, lastColumn, firstRow, lastRow;
+	if(!cellRange(area, firstColumn, lastColumn, firstRow, lastRow))
+		return false;
+
+	for(int row = firstRow; row <= lastRow; ++row) {
+		for(int column = firstColumn; column <= lastColumn; ++column) {
+			int cell = row*columns_ + column;
+			for(int k = cellStart_.at(cell), end = cellStart_.at(cell+1); k < end; ++k)
+				if(segmentIntersectsRect(segments_.at(cellSegments_.at(k)), area))
+					return true;
+		}
+	}
+	return false;
+}
+
+qreal MPlotSegmentIndex::distanceToSegment(const QPointF &point, const QLineF &segment)
+{
+	qreal dx = segment.x2() - segment.x1();
+	qreal dy = segment.y2() - segment.y1();
+	qreal px = point.x() - segment.x1();
+	qreal py = point.y() - segment.y1();
+
+	// Project the point onto the segment, and clamp the projection to the ends.
+	qreal lengthSquared = dx*dx + dy*dy;
+	qreal t = lengthSquared > 0 ? (px*dx + py*dy)/lengthSquared : 0;
+	if(t < 0)
+		t = 0;
+	else if(t > 1)
+		t = 1;
+
+	qreal ex = px - t*dx;
+	qreal ey = py - t*dy;
+	return qSqrt(ex*ex + ey*ey);
+}
+
+bool MPlotSegmentIndex::segmentIntersectsRect(const QLineF &segment, const QRectF &rect)
+{
+	// Liang-Barsky: clip the segment's parameter range [0,1] against each edge of the rectangle.
+	qreal dx = segment.x2() - segment.x1();
+	qreal dy = segment.y2() - segment.y1();
+	qreal p[4] = { -dx, dx, -dy, dy };
+	qreal q[4] = { segment.x1() - rect.left(), rect.right() - segment.x1(), segment.y1() - rect.top(), rect.bottom() - segment.y1() };
+
+	qreal t0 = 0, t1 = 1;
+	for(int i = 0; i < 4; ++i) {
+		if(p[i] == 0) {
+			// Parallel to this edge: completely outside, or not limited by it.
+			if(q[i] < 0)
+				return false;
+		}
+		else {
+			qreal t = q[i]/p[i];
+			if(p[i] < 0) {
+				if(t > t1)
+					return false;
+				if(t > t0)
+					t0 = t;
+			}
+			else {
+				if(t < t0)
+					return false;
+				if(t < t1)
+					t1 = t;
+			}
+		}
+	}
+	return true;
+}
+
+void MPlotSegmentIndex::cellsForSegment(const QLineF &segment, QVector<int> &cells) const
+{
+	// Work in cell units, from left to right.
+	qreal x1 = (segment.x1() - bounds_.left())/cellSize_;
+	qreal y1 = (segment.y1() - bounds_.top())/cellSize_;
+	qreal x2 = (segment.x2() - bounds_.left())/cellSize_;
+	qreal y2 = (segment.y2() - bounds_.top())/cellSize_;
+	if(x2 < x1) {
+		qSwap(x1, x2);
+		qSwap(y1, y2);
+	}
+
+	int firstColumn = qBound(0, int(x1), columns_-1);
+	int lastColumn = qBound(0, int(x2), columns_-1);
+
+	for(int column = firstColumn; column <= lastColumn; ++column) {
+		// The rows this segment covers within this column:
+		qreal ya = y1, yb = y2;
+		if(x2 > x1) {
+			qreal slope = (y2-y1)/(x2-x1);
+			ya = y1 + (qMax(x1, qreal(column)) - x1)*slope;
+			yb = y1 + (qMin(x2, qreal(column+1)) - x1)*slope;
+		}
+		int firstRow = qBound(0, int(qMin(ya, yb)), rows_-1);
+		int lastRow = qBound(0, int(qMax(ya, yb)), rows_-1);
+		for(int row = firstRow; row <= lastRow; ++row)
+			cells << row*columns_ + column;
+	}
+}
+
+bool MPlotSegmentIndex::cellRange(const QRectF &rect, int &firstColumn, int &lastColumn, int &firstRow, int &lastRow) const
+{
+	if(!(rect.right() >= bounds_.left() && rect.left() <= bounds_.right() && rect.bottom() >= bounds_.top() && rect.top() <= bounds_.bottom()))
+		return false;
+
+	// (Clamped before converting to int, since the rectangle can be much larger than the grid.)
+	firstColumn = int(qBound(qreal(0), (rect.left() - bounds_.left())/cellSize_, qreal(columns_-1)));
+	lastColumn = int(qBound(qreal(0), (rect.right() - bounds_.left())/cellSize_, qreal(columns_-1)));
+	firstRow = int(qBound(qreal(0), (rect.top() - bounds_.top())/cellSize_, qreal(rows_-1)));
+	lastRow = int(qBound(qreal(0), (rect.bottom() - bounds_.top())/cellSize_, qreal(rows_-1)));
+	return true;
+}
+
+quint32 MPlotSegmentIndex::nextVisitStamp() const
+{
+	if(++visitStamp_ == 0) {
+		visited_.fill(0);
+		visitStamp_ = 1;
+	}
+	return visitStamp_;
+}
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef MPLOTSEGMENTINDEX_H
+#define MPLOTSEGMENTINDEX_H
+
+#include "MPlot/MPlot_global.h"
+
+#include <QVector>
+#include <QLineF>
+#include <QPointF>
+#include <QRectF>
+
+/// A uniform grid over a set of line segments, used to find the segments near a point (for hit-testing) without checking all of them.
+/*! The grid covers the bounding box of the segments, with about as many cells as there are segments.  Each segment is listed in every cell it actually passes through (not every cell of its bounding box), so long diagonal segments don't fill the grid.  A query only looks at the segments listed in the cells around the query area, so its cost depends on how many segments are nearby, rather than on the total number.
+
+  The cell lists are stored one after the other in a single array (cellStart_ and cellSegments_), so building the index takes two allocations no matter how many segments there are.
+
+  The index is static: call build() again whenever the segments change.  Queries are not thread-safe, since they share the scratch space used to avoid checking a segment twice.
+  */
+class MPLOTSHARED_EXPORT MPlotSegmentIndex {
+
+public:
+	/// Constructs an empty index.
+	MPlotSegmentIndex();
+
+	/// Re-builds the index over the separate segments in \c lines, and the segments of the polylines in \c polylinePoints (where the first polyline has polylineLengths[0] points, the next one polylineLengths[1] points, etc.).  Segments with NaN or infinite coordinates are ignored.
+	void build(const QVector<QLineF>& lines, const QVector<QPointF>& polylinePoints = QVector<QPointF>(), const QVector<int>& polylineLengths = QVector<int>());
+	/// Removes all the segments.
+	void clear();
+
+	/// Returns the number of segments indexed.
+	int count() const { return segments_.count(); }
+	/// Returns true if there are no segments.
+	bool isEmpty() const { return segments_.isEmpty(); }
+	/// Returns segment \c i.
+	const QLineF& segment(int i) const { return segments_.at(i); }
+	/// Returns the bounding box of all the segments.
+	QRectF bounds() const { return bounds_; }
+
+	/// Returns the index of the segment closest to \c point, if it's within \c maxDistance of \c point; otherwise returns -1.  If \c distance is not 0, it is set to the distance to that segment.
+	int nearestSegment(const QPointF& point, qreal maxDistance, qreal* distance = 0) const;
+	/// Returns true if any segment passes through \c rect.
+	bool intersects(const QRectF& rect) const;
+
+	/// Returns the distance between \c point and the closest point on \c segment.
+	static qreal distanceToSegment(const QPointF& point, const QLineF& segment);
+	/// Returns true if any part of \c segment is inside \c rect.
+	static bool segmentIntersectsRect(const QLineF& segment, const QRectF& rect);
+
+protected:
+	/// Appends the indexes of the cells that \c segment passes through to \c cells.
+	void cellsForSegment(const QLineF& segment, QVector<int>& cells) const;
+	/// Finds the range of cell columns (\c firstColumn to \c lastColumn) and rows (\c firstRow to \c lastRow) covering \c rect.  Returns false if \c rect is outside the grid.
+	bool cellRange(const QRectF& rect, int& firstColumn, int& lastColumn, int& firstRow, int& lastRow) const;
+	/// Starts a new query: returns the stamp to mark visited segments with in visited_.
+	quint32 nextVisitStamp() const;
+
+	/// All the segments.
+	QVector<QLineF> segments_;
+	/// The bounding box of the segments, which is the area covered by the grid.
+	QRectF bounds_;
+	/// The width and height of each cell.
+	qreal cellSize_;
+	/// The number of cell columns and rows.
+	int columns_, rows_;
+	/// The segments in cell i (numbered row by row) are cellSegments_[cellStart_[i]] up to cellSegments_[cellStart_[i+1]-1].
+	QVector<int> cellStart_;
+	QVector<int> cellSegments_;
+
+	/// For each segment, the stamp of the last query that checked it.  A segment can be listed in several cells, but only needs to be checked once per query.
+	mutable QVector<quint32> visited_;
+	/// The stamp of the last query.
+	mutable quint32 visitStamp_;
+};
+
+#endif // MPLOTSEGMENTINDEX_H
@@ -2,8 +2,17 @@
 #define __MPlotSeries_CPP__
 
 #include "MPlot/MPlotSeries.h"
+#include "MPlot/MPlotMinMaxPyramid.h"
+#include "MPlot/MPlotSimd.h"
 #include <QPainter>
+#include <QPaintEngine>
+#include <QtConcurrentRun>
 #include <QDebug>
+#include <qnumeric.h>
+#include <qmath.h>
+
+#include <string.h>
+#include <limits>
 
 MPlotSeriesSignalHandler::MPlotSeriesSignalHandler(MPlotAbstractSeries *parent)
 	: QObject(0) {
@@ -11,7 +20,30 @@ MPlotSeriesSignalHandler::MPlotSeriesSignalHandler(MPlotAbstractSeries *parent)
 }
 
 void MPlotSeriesSignalHandler::onDataChanged() {
-	series_->onDataChangedPrivate();
+	// Already handled by one of the detailed notifications?
+	if(series_->detailedDataChangeHandled_) {
+		series_->detailedDataChangeHandled_ = false;
+		return;
+	}
+	series_->onModelDataChangedPrivate();
+}
+
+void MPlotSeriesSignalHandler::onDataRangeChanged(int first, int last) {
+	series_->onDetailedDataChangePrivate(first, last, false);
+}
+
+void MPlotSeriesSignalHandler::onPointsAppended(int n) {
+	int count = series_->data_->count();
+	series_->onDetailedDataChangePrivate(count-n, count-1, true);
+}
+
+void MPlotSeriesSignalHandler::onPointsRemovedFront(int n) {
+	Q_UNUSED(n)
+	series_->onDetailedDataChangePrivate(0, -1, false);
+}
+
+void MPlotSeriesSignalHandler::onRenderFinished() {
+	series_->onRenderFinished();
 }
 
 MPlotAbstractSeries::MPlotAbstractSeries() :
@@ -19,7 +51,13 @@ MPlotAbstractSeries::MPlotAbstractSeries() :
 {
 	data_ = 0;
 	marker_ = 0;
+	markerShape_ = MPlotMarkerShape::None;
 	dataChangedUpdateNeeded_ = true;
+	detailedDataChangeHandled_ = false;
+	deferredFullChange_ = false;
+	deferredRangeChange_ = false;
+	deferredFirst_ = deferredLast_ = 0;
+	deferredAppended_ = false;
 
 	/// Scale and shift factors
 	sx_ = sy_ = 1.0;
@@ -68,6 +106,7 @@ void MPlotAbstractSeries::setMarker(MPlotMarkerShape::Shape shape, qreal size, c
 		delete marker_;
 
 	marker_ = MPlotMarker::create(shape, size, pen, brush);
+	markerShape_ = marker_ ? shape : MPlotMarkerShape::None;
 	update();
 }
 
@@ -94,11 +133,17 @@ void MPlotAbstractSeries::setModel(const MPlotAbstractSeriesData* data, bool own
 	ownsModel_ = ownsModel;
 
 	dataChangedUpdateNeeded_ = true;
+	detailedDataChangeHandled_ = false;
+	deferredFullChange_ = false;
+	deferredRangeChange_ = false;
 	prepareGeometryChange();
 
 	// If there's a new valid model:
 	if(data_) {
 		QObject::connect(data_->signalSource(), SIGNAL(dataChanged()), signalHandler_, SLOT(onDataChanged()));
+		QObject::connect(data_->signalSource(), SIGNAL(dataRangeChanged(int,int)), signalHandler_, SLOT(onDataRangeChanged(int,int)));
+		QObject::connect(data_->signalSource(), SIGNAL(pointsAppended(int)), signalHandler_, SLOT(onPointsAppended(int)));
+		QObject::connect(data_->signalSource(), SIGNAL(pointsRemovedFront(int)), signalHandler_, SLOT(onPointsRemovedFront(int)));
 	}
 
 	emitBoundsChanged();
@@ -110,24 +155,113 @@ const MPlotAbstractSeriesData* MPlotAbstractSeries::model() const { return data_
 
 void MPlotAbstractSeries::xxValues(unsigned start, unsigned end, qreal *outputValues) const
 {
-	qreal offset = offset_.x();
+	qreal shift = dx_ + offset_.x();
 	int size = end-start+1;
-	QVector<qreal> x = QVector<qreal>(size);
-	data_->xValues(start, end, x.data());
 
-	for (int i = 0; i < size; i++)
-		outputValues[i] = x.at(i)*sx_ + dx_ + offset;
+	// Read straight from the model's memory if it allows that...
+	MPlotDataSpan span = data_->xSpan(start, end);
+	if(!span.isNull()) {
+		transformValues(size, span.data(), span.stride(), sx_, shift, outputValues);
+		return;
+	}
+
+	// ... otherwise copy the values out, and transform them in place.
+	data_->xValues(start, end, outputValues);
+	transformValues(size, outputValues, 1, sx_, shift, outputValues);
 }
 
 void MPlotAbstractSeries::yyValues(unsigned start, unsigned end, qreal *outputValues) const
 {
-	qreal offset = offset_.y();
+	qreal shift = dy_ + offset_.y();
 	int size = end-start+1;
-	QVector<qreal> y = QVector<qreal>(size);
-	data_->yValues(start, end, y.data());
 
-	for (int i = 0; i < size; i++)
-		outputValues[i] = y.at(i)*sy_ + dy_ + offset;
+	MPlotDataSpan span = data_->ySpan(start, end);
+	if(!span.isNull()) {
+		transformValues(size, span.data(), span.stride(), sy_, shift, outputValues);
+		return;
+	}
+
+	data_->yValues(start, end, outputValues);
+	transformValues(size, outputValues, 1, sy_, shift, outputValues);
+}
+
+void MPlotAbstractSeries::mapXXValues(unsigned start, unsigned end, qreal *outputValues) const
+{
+	MPlotAxisMapping mapping = xAxisTarget()->mapping();
+	qreal shift = dx_ + offset_.x();
+
+	MPlotDataSpan span = data_->xSpan(start, end);
+	if(!span.isNull()) {
+		transformAndMapValues(end-start+1, span.data(), span.stride(), sx_, shift, mapping, outputValues);
+		return;
+	}
+
+	// Copy through a small buffer that stays in cache, instead of a full-size temporary.
+	qreal chunk[MPLOT_MAPPING_CHUNK_SIZE];
+	for(unsigned i = start; i <= end; i += MPLOT_MAPPING_CHUNK_SIZE) {
+		unsigned last = qMin(end, i + MPLOT_MAPPING_CHUNK_SIZE - 1);
+		data_->xValues(i, last, chunk);
+		transformAndMapValues(last-i+1, chunk, 1, sx_, shift, mapping, outputValues + (i-start));
+	}
+}
+
+void MPlotAbstractSeries::mapYYValues(unsigned start, unsigned end, qreal *outputValues) const
+{
+	MPlotAxisMapping mapping = yAxisTarget()->mapping();
+	qreal shift = dy_ + offset_.y();
+
+	MPlotDataSpan span = data_->ySpan(start, end);
+	if(!span.isNull()) {
+		transformAndMapValues(end-start+1, span.data(), span.stride(), sy_, shift, mapping, outputValues);
+		return;
+	}
+
+	qreal chunk[MPLOT_MAPPING_CHUNK_SIZE];
+	for(unsigned i = start; i <= end; i += MPLOT_MAPPING_CHUNK_SIZE) {
+		unsigned last = qMin(end, i + MPLOT_MAPPING_CHUNK_SIZE - 1);
+		data_->yValues(i, last, chunk);
+		transformAndMapValues(last-i+1, chunk, 1, sy_, shift, mapping, outputValues + (i-start));
+	}
+}
+
+void MPlotAbstractSeries::transformAndMapValues(int size, const qreal *input, int stride, qreal scale, qreal shift, const MPlotAxisMapping &mapping, qreal *outputValues)
+{
+	if(mapping.degenerate) {
+		for (int i = 0; i < size; i++)
+			outputValues[i] = 1;
+	}
+
+	else if(!mapping.logScale) {
+		// Both steps are linear, so they collapse into a single multiply-add.
+		qreal a = mapping.scale*scale;
+		qreal b = mapping.scale*shift + mapping.offset;
+		if(stride == 1)
+			MPlotSimd::affine(size, input, a, b, outputValues);
+		else
+			for (int i = 0; i < size; i++)
+				outputValues[i] = input[i*stride]*a + b;
+	}
+
+	else if(stride == 1)
+		MPlotSimd::logAffine(size, input, scale, shift, mapping.logFloor, mapping.scale, mapping.offset, outputValues);
+
+	else {
+		for (int i = 0; i < size; i++) {
+			qreal value = input[i*stride]*scale + shift;
+			if(value <= 0.0)
+				value = mapping.logFloor;
+			outputValues[i] = mapping.scale*log10(value) + mapping.offset;
+		}
+	}
+}
+
+void MPlotAbstractSeries::transformValues(int size, const qreal *input, int stride, qreal scale, qreal shift, qreal *outputValues)
+{
+	if(stride == 1)
+		MPlotSimd::affine(size, input, scale, shift, outputValues);
+	else
+		for (int i = 0; i < size; i++)
+			outputValues[i] = input[i*stride]*scale + shift;
 }
 
 // Required functions:
@@ -139,6 +273,7 @@ QRectF MPlotAbstractSeries::dataRect() const {
 	if(dataChangedUpdateNeeded_) {
 		if(data_) {
 			cachedDataRect_ = data_->boundingRect();
+			cachedModelRect_ = cachedDataRect_;
 
 			if(yAxisNormalizationOn_) {
 //				sy_ = (normYMax_ - normYMin_)/(qMax(MPLOT_MIN_NORMALIZATION_RANGE, cachedDataRect_.height()));
@@ -186,17 +321,11 @@ QPainterPath MPlotAbstractSeries::shape() const {
 	else if (data_ && data_->count() > 0){
 
 		int dataCount = data_->count();
-		QVector<qreal> x = QVector<qreal>(dataCount);
-		QVector<qreal> y = QVector<qreal>(dataCount);
-
-		xxValues(0, dataCount-1, x.data());
-		yyValues(0, dataCount-1, y.data());
-
 		QVector<qreal> mappedX = QVector<qreal>(dataCount);
 		QVector<qreal> mappedY = QVector<qreal>(dataCount);
 
-		mapXValues(mappedX.size(), x.constData(), mappedX.data());
-		mapYValues(mappedY.size(), y.constData(), mappedY.data());
+		mapXXValues(0, dataCount-1, mappedX.data());
+		mapYYValues(0, dataCount-1, mappedY.data());
 
 		shape.moveTo(mappedX.at(0), mappedY.at(0));
 
@@ -224,6 +353,214 @@ void	MPlotAbstractSeries::onDataChangedPrivate() {
 	onDataChanged();
 }
 
+void MPlotAbstractSeries::visibleIndexRange(int &firstIndex, int &lastIndex, const QRectF &exposedRect) const
+{
+	int count = data_->count();
+	firstIndex = 0;
+	lastIndex = count-1;
+
+	if(count < 3 || !xAxisTarget() || sx_ == 0 || !data_->isXMonotonic())
+		return;
+
+	qreal visibleMin = qMin(xAxisTarget()->min(), xAxisTarget()->max());
+	qreal visibleMax = qMax(xAxisTarget()->min(), xAxisTarget()->max());
+	// Only part of the plot needs to be drawn?
+	if(exposedRect.isValid() && !xAxisTarget()->logScaleInEffect()) {
+		qreal exposedMin = xAxisTarget()->mapDrawingToData(exposedRect.left());
+		qreal exposedMax = xAxisTarget()->mapDrawingToData(exposedRect.right());
+		visibleMin = qMax(visibleMin, qMin(exposedMin, exposedMax));
+		visibleMax = qMin(visibleMax, qMax(exposedMin, exposedMax));
+	}
+	if(visibleMin > visibleMax)
+		visibleMax = visibleMin;
+	// On a log axis, values <= 0 are drawn at the low end, so they're visible too.
+	if(xAxisTarget()->logScaleInEffect())
+		visibleMin = -std::numeric_limits<qreal>::infinity();
+
+	// Undo the series transform (xx = x*sx_ + dx_ + offset_.x()) to get the visible range in model coordinates.
+	qreal shift = dx_ + offset_.x();
+	qreal xMin = (visibleMin - shift)/sx_;
+	qreal xMax = (visibleMax - shift)/sx_;
+	if(xMin > xMax)
+		qSwap(xMin, xMax);
+	if(!(xMin <= xMax))
+		return;
+
+	int first, last;
+	if(!data_->indexRangeForX(xMin, xMax, first, last))
+		return;
+
+	// Include the neighbouring points, so that lines leaving the visible area are drawn up to the edge.
+	firstIndex = qBound(0, first-1, count-1);
+	lastIndex = qBound(firstIndex, last+1, count-1);
+}
+
+int MPlotAbstractSeries::nearestPointIndex(const QPointF &drawingPosition, qreal maxDistance, qreal *distance) const
+{
+	if(!data_ || !xAxisTarget() || !yAxisTarget())
+		return -1;
+	int count = data_->count();
+	if(count == 0)
+		return -1;
+
+	int best = -1;
+	qreal bestSquared = maxDistance < 0 ? std::numeric_limits<qreal>::infinity() : maxDistance*maxDistance;
+	QVector<qreal> mappedX = QVector<qreal>(qMin(count, MPLOT_NEARESTPOINT_BLOCK_SIZE));
+	QVector<qreal> mappedY = QVector<qreal>(mappedX.size());
+
+	// Undo the series transform to find the model x-value under drawingPosition.
+	qreal targetX = (xAxisTarget()->mapDrawingToData(drawingPosition.x()) - dx_ - offset_.x())/sx_;
+	int first, last;
+	if(count < 3 || sx_ == 0 || !(targetX == targetX) || !data_->isXMonotonic() || !data_->indexRangeForX(targetX, targetX, first, last)) {
+		for(int i = 0; i < count; i += MPLOT_NEARESTPOINT_BLOCK_SIZE)
+			nearestPointInRange(i, qMin(count-1, i + MPLOT_NEARESTPOINT_BLOCK_SIZE - 1), drawingPosition, 0, 0, best, bestSquared, mappedX.data(), mappedY.data());
+	}
+
+	else {
+		const MPlotMinMaxPyramid* lod = data_->levelOfDetail();
+		if(lod && !lod->isXAscending())
+			lod = 0;
+
+		// Points from \c right onwards are on one side of drawingPosition, and points from \c left down are on the other, so the horizontal distance only grows in each direction.  Alternate between the two, so that a close point found on one side can end the search on the other.
+		int right = first;
+		int left = first-1;
+		while(right < count || left >= 0) {
+			if(right < count) {
+				qreal dx = xAxisTarget()->mapDataToDrawing(xx(unsigned(right))) - drawingPosition.x();
+				if(dx*dx >= bestSquared)
+					right = count;
+				else {
+					int end = qMin(count-1, right + MPLOT_NEARESTPOINT_BLOCK_SIZE - 1);
+					nearestPointInRange(right, end, drawingPosition, dx*dx, lod, best, bestSquared, mappedX.data(), mappedY.data());
+					right = end+1;
+				}
+			}
+			if(left >= 0) {
+				qreal dx = xAxisTarget()->mapDataToDrawing(xx(unsigned(left))) - drawingPosition.x();
+				if(dx*dx >= bestSquared)
+					left = -1;
+				else {
+					int start = qMax(0, left - MPLOT_NEARESTPOINT_BLOCK_SIZE + 1);
+					nearestPointInRange(start, left, drawingPosition, dx*dx, lod, best, bestSquared, mappedX.data(), mappedY.data());
+					left = start-1;
+				}
+			}
+		}
+	}
+
+	if(best >= 0 && distance)
+		*distance = qSqrt(bestSquared);
+	return best;
+}
+
+void MPlotAbstractSeries::nearestPointInRange(int first, int last, const QPointF &position, qreal xDistanceSquared, const MPlotMinMaxPyramid *lod, int &best, qreal &bestSquared, qreal *mappedX, qreal *mappedY) const
+{
+	// Rule out the whole range from its y-extent, if we can.
+	if(lod) {
+		qreal minY, maxY;
+		lod->yRange(first, last, minY, maxY);
+		if(!(minY <= maxY))
+			return;	// all NaN
+
+		qreal y1 = yAxisTarget()->mapDataToDrawing(minY*sy_ + dy_ + offset_.y());
+		qreal y2 = yAxisTarget()->mapDataToDrawing(maxY*sy_ + dy_ + offset_.y());
+		qreal top = qMin(y1, y2);
+		qreal bottom = qMax(y1, y2);
+		qreal dy = 0;
+		if(position.y() < top)
+			dy = top - position.y();
+		else if(position.y() > bottom)
+			dy = position.y() - bottom;
+		if(xDistanceSquared + dy*dy >= bestSquared)
+			return;
+	}
+
+	mapXXValues(unsigned(first), unsigned(last), mappedX);
+	mapYYValues(unsigned(first), unsigned(last), mappedY);
+
+	for(int i = 0, n = last-first+1; i < n; ++i) {
+		qreal dx = mappedX[i] - position.x();
+		qreal dy = mappedY[i] - position.y();
+		qreal d = dx*dx + dy*dy;
+		if(d < bestSquared) {
+			bestSquared = d;
+			best = first + i;
+		}
+	}
+}
+
+void MPlotAbstractSeries::onModelDataChangedPrivate()
+{
+	if(deferDataChange()) {
+		deferredFullChange_ = true;
+		return;
+	}
+
+	onDataChangedPrivate();
+}
+
+void MPlotAbstractSeries::onDetailedDataChangePrivate(int first, int last, bool appended)
+{
+	detailedDataChangeHandled_ = true;
+
+	if(deferDataChange()) {
+		if(!deferredRangeChange_) {
+			deferredRangeChange_ = true;
+			deferredFirst_ = first;
+			deferredLast_ = last;
+			deferredAppended_ = appended;
+		}
+		// Once the change can't be located (ex: points removed from the front, which also shifts the indexes recorded so far), it stays that way until the next frame.
+		else if(deferredLast_ >= deferredFirst_) {
+			if(last < first) {
+				deferredFirst_ = 0;
+				deferredLast_ = -1;
+			}
+			else {
+				deferredFirst_ = qMin(deferredFirst_, first);
+				deferredLast_ = qMax(deferredLast_, last);
+			}
+			deferredAppended_ = deferredAppended_ && appended;
+		}
+		return;
+	}
+
+	handleDetailedDataChange(first, last, appended);
+}
+
+void MPlotAbstractSeries::flushDeferredDataChange()
+{
+	bool fullChange = deferredFullChange_;
+	bool rangeChange = deferredRangeChange_;
+	deferredFullChange_ = false;
+	deferredRangeChange_ = false;
+
+	if(!data_)
+		return;
+
+	if(fullChange)
+		onDataChangedPrivate();
+	else if(rangeChange)
+		handleDetailedDataChange(deferredFirst_, deferredLast_, deferredAppended_);
+}
+
+void MPlotAbstractSeries::handleDetailedDataChange(int first, int last, bool appended)
+{
+	// If the bounds are the same, nothing changes for the plot or the scene: just redraw what changed.
+	if(!dataChangedUpdateNeeded_ && data_ && data_->boundingRect() == cachedModelRect_)
+		onDataRangeChanged(first, last, appended);
+	else
+		onDataChangedPrivate();
+}
+
+void MPlotAbstractSeries::onDataRangeChanged(int firstIndex, int lastIndex, bool appended)
+{
+	Q_UNUSED(firstIndex)
+	Q_UNUSED(lastIndex)
+	Q_UNUSED(appended)
+	onDataChanged();
+}
+
 void MPlotAbstractSeries::setDefaults() {
 
 	setLinePen(QPen(QColor(Qt::red)));	// Red solid lines on plot
@@ -291,6 +628,20 @@ void MPlotAbstractSeries::setOffset(qreal dx, qreal dy) {
 MPlotSeriesBasic::MPlotSeriesBasic(const MPlotAbstractSeriesData* data)
 	: MPlotAbstractSeries() {
 
+	// So that paint() gets the exposedRect, and can skip points outside of it.
+	setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, true);
+	markerSpritesEnabled_ = true;
+	markerDeduplicationEnabled_ = false;
+	geometryCacheEnabled_ = true;
+	lineCache_.valid = false;
+	lineCacheGeneration_ = 0;
+	segmentIndexGeneration_ = 0;
+	asyncRenderingEnabled_ = false;
+	asyncDataVersion_ = 0;
+	asyncRenderWatcher_ = 0;
+	asyncRenderRunning_ = false;
+	asyncImageReady_ = false;
+
 	// Set style defaults:
 	setDefaults();
 
@@ -298,7 +649,11 @@ MPlotSeriesBasic::MPlotSeriesBasic(const MPlotAbstractSeriesData* data)
 }
 
 MPlotSeriesBasic::~MPlotSeriesBasic() {
-
+	// A running render only uses its own copy of everything, but it must finish before its watcher goes away.
+	if(asyncRenderWatcher_) {
+		asyncRenderWatcher_->waitForFinished();
+		delete asyncRenderWatcher_;
+	}
 }
 
 // Required functions:
@@ -330,13 +685,27 @@ void MPlotSeriesBasic::paint(QPainter* painter,
 							 const QStyleOptionGraphicsItem* option,
 							 QWidget* widget) {
 
-	Q_UNUSED(option);
 	Q_UNUSED(widget);
 
 	if(!yAxisTarget() || !xAxisTarget()) {
 		qWarning() << "MPlotSeriesBasic: No axis scale set. Abandoning painting because we don't know what scale to use.";
 		return;
 	}
+
+	if(asyncRenderingEnabled_ && paintAsync(painter))
+		return;
+
+	// When only part of the item needs to be re-drawn, points whose markers and lines can't reach that part can be skipped.
+	exposedRect_ = QRectF();
+	if(option && option->exposedRect.isValid()) {
+		QRectF all = boundingRect();
+		if(!option->exposedRect.contains(all)) {
+			qreal margin = MPLOT_SELECTION_LINEWIDTH + linePen_.widthF() + 2;
+			if(marker_)
+				margin += marker_->size() + marker_->pen().widthF();
+			exposedRect_ = option->exposedRect.adjusted(-margin, -margin, margin, margin);
+		}
+	}
 	// Plot the markers. Here what makes sense is one marker per data point.  This will be slow for large datasets.
 	// use plot->setMarkerShape(MPlotMarkerShape::None) for large sets.
 	/////////////////////////////////////////
@@ -355,6 +724,8 @@ void MPlotSeriesBasic::paint(QPainter* painter,
 	}
 	painter->setPen(linePen_);
 	paintLines(painter);
+
+	exposedRect_ = QRectF();
 }
 
 void MPlotSeriesBasic::paintLines(QPainter* painter) {
@@ -366,90 +737,665 @@ void MPlotSeriesBasic::paintLines(QPainter* painter) {
 		QTransform wt = painter->deviceTransform();	// equivalent to worldTransform and combinedTransform
 		qreal xinc = 1.0 / wt.m11() / MPLOT_MAX_LINES_PER_PIXEL;	// will just be 1/MPLOT_MAX_LINES_PER_PIXEL = 0.5 as long as not using a scaled/transformed painter.
 
-		int dataCount = data_->count();
-		QVector<qreal> x = QVector<qreal>(dataCount);
-		QVector<qreal> y = QVector<qreal>(dataCount);
+		// Only the points inside the visible x range (and their neighbours) need to be drawn.
+		int firstIndex, lastIndex;
+		visibleIndexRange(firstIndex, lastIndex);
 
-		xxValues(0, dataCount-1, x.data());
-		yyValues(0, dataCount-1, y.data());
+		if(!geometryCacheEnabled_) {
+			paintVisibleLines(painter, xinc, firstIndex, lastIndex);
+			return;
+		}
 
-		QVector<qreal> mappedX = QVector<qreal>(dataCount);
-		QVector<qreal> mappedY = QVector<qreal>(dataCount);
+		// If nothing the lines depend on has changed since they were last drawn, draw the same lines again.
+		if(lineCacheMatches(xinc, firstIndex, lastIndex)) {
+			paintCachedLines(painter);
+			return;
+		}
 
-		mapXValues(mappedX.size(), x.constData(), mappedX.data());
-		mapYValues(mappedY.size(), y.constData(), mappedY.data());
+		// Record the lines while drawing them, unless they're only being drawn for the exposed area.  (That only happens without sub-sampling; see paintVisibleLines().)
+		bool subSampled = lastIndex-firstIndex+1 >= xAxisTarget()->drawingSize().width()/xinc;
+		if(!subSampled && exposedRect_.isValid()) {
+			paintVisibleLines(painter, xinc, firstIndex, lastIndex);
+			return;
+		}
+
+		recordLines(painter, xinc, firstIndex, lastIndex);
+	}
+}
+
+bool MPlotSeriesBasic::lineCacheMatches(qreal xinc, int firstIndex, int lastIndex) const
+{
+	return lineCache_.valid
+			&& lineCache_.xinc == xinc
+			&& lineCache_.drawingWidth == xAxisTarget()->drawingSize().width()
+			&& lineCache_.firstIndex == firstIndex
+			&& lineCache_.lastIndex == lastIndex
+			&& lineCache_.xMapping == xAxisTarget()->mapping()
+			&& lineCache_.yMapping == yAxisTarget()->mapping();
+}
 
-		// should we just draw normally and quickly? Do that if the number of data points is less than the number of x-pixels in the drawing space (or half-pixels, in the conservative case where MPLOT_MAX_LINES_PER_PIXEL = 2).
-		if(data_->count() < xAxisTarget()->drawingSize().width()/xinc) {
+void MPlotSeriesBasic::recordLines(QPainter *painter, qreal xinc, int firstIndex, int lastIndex)
+{
+	lineCache_.valid = false;
+	lineCache_.lines.clear();
+	lineCache_.polylinePoints.clear();
+	lineCache_.polylineLengths.clear();
+
+	lineBatch_.record = &lineCache_;
+	paintVisibleLines(painter, xinc, firstIndex, lastIndex);
+	lineBatch_.record = 0;
+
+	lineCache_.valid = true;
+	lineCache_.xMapping = xAxisTarget()->mapping();
+	lineCache_.yMapping = yAxisTarget()->mapping();
+	lineCache_.xinc = xinc;
+	lineCache_.drawingWidth = xAxisTarget()->drawingSize().width();
+	lineCache_.firstIndex = firstIndex;
+	lineCache_.lastIndex = lastIndex;
+	lineCacheGeneration_++;
+}
 
-			for (int i = 1, count = data_->count(); i < count; i++)
-				painter->drawLine(QPointF(mappedX.at(i-1), mappedY.at(i-1)), QPointF(mappedX.at(i), mappedY.at(i)));
+void MPlotSeriesBasic::updateSegmentIndex()
+{
+	if(!data_ || data_->count() == 0 || !xAxisTarget() || !yAxisTarget()) {
+		segmentIndex_.clear();
+		lineCache_.valid = false;	// so that the index is re-built once there is something to draw
+		return;
+	}
+
+	// The same lines that paintLines() draws on an unscaled view.
+	qreal xinc = 1.0 / MPLOT_MAX_LINES_PER_PIXEL;
+	int firstIndex, lastIndex;
+	visibleIndexRange(firstIndex, lastIndex);
+
+	if(!lineCacheMatches(xinc, firstIndex, lastIndex))
+		recordLines(0, xinc, firstIndex, lastIndex);
+
+	if(segmentIndexGeneration_ != lineCacheGeneration_) {
+		segmentIndex_.build(lineCache_.lines, lineCache_.polylinePoints, lineCache_.polylineLengths);
+		segmentIndexGeneration_ = lineCacheGeneration_;
+	}
+}
+
+bool MPlotSeriesBasic::hitTest(const QRectF &region)
+{
+	updateSegmentIndex();
+	return segmentIndex_.intersects(region);
+}
+
+bool MPlotSeriesBasic::nearestDrawnSegment(const QPointF &point, qreal maxDistance, QLineF *segment, qreal *distance)
+{
+	updateSegmentIndex();
+
+	qreal d;
+	int i = segmentIndex_.nearestSegment(point, maxDistance, &d);
+	if(i < 0)
+		return false;
+
+	if(segment)
+		*segment = segmentIndex_.segment(i);
+	if(distance)
+		*distance = d;
+	return true;
+}
+
+void MPlotSeriesBasic::paintVisibleLines(QPainter *painter, qreal xinc, int firstIndex, int lastIndex)
+{
+	int dataCount = lastIndex-firstIndex+1;
+
+	// If we'll need to sub-sample, and the model has a min/max index: we can skip fetching and mapping every point.
+	if(dataCount >= xAxisTarget()->drawingSize().width()/xinc && paintLinesFromLevelOfDetail(painter, xinc, firstIndex, lastIndex))
+		return;
+
+	// If we're not sub-sampling, each line only depends on its two points, so we only need the ones that can reach the exposed area.  (Sub-sampled lines depend on where the sub-sampling started, so they must all be drawn the same way every time.)
+	if(dataCount < xAxisTarget()->drawingSize().width()/xinc && exposedRect_.isValid()) {
+		visibleIndexRange(firstIndex, lastIndex, exposedRect_);
+		dataCount = lastIndex-firstIndex+1;
+	}
+
+	QVector<qreal> mappedX = QVector<qreal>(dataCount);
+	QVector<qreal> mappedY = QVector<qreal>(dataCount);
+
+	mapXXValues(unsigned(firstIndex), unsigned(lastIndex), mappedX.data());
+	mapYYValues(unsigned(firstIndex), unsigned(lastIndex), mappedY.data());
+
+	drawMappedLines(painter, lineBatch_, mappedX.constData(), mappedY.constData(), dataCount, xinc, dataCount >= xAxisTarget()->drawingSize().width()/xinc);
+}
+
+bool MPlotSeriesBasic::paintLinesFromLevelOfDetail(QPainter *painter, qreal xinc, int firstIndex, int lastIndex)
+{
+	const MPlotMinMaxPyramid* lod = data_->levelOfDetail();
+	if(!lod || !lod->isXAscending())
+		return false;
+
+	// This is the same sub-sampling as in paintLines(): a vertical line covering the y-extent of each xinc range, and a line connecting each range to the next.  Since x is sorted, each range is a contiguous block of indexes, which we can find with a binary search.  The y-extent comes from the min/max index.
+	int count = lastIndex+1;
+
+	// Drawing x-values are sorted too, but may run backwards depending on the transform and the axis scale.
+	qreal direction = mapX(xx(lastIndex)) < mapX(xx(firstIndex)) ? -1.0 : 1.0;
+	qreal yScale = sy_;
+	qreal yShift = dy_ + offset_.y();
+
+	qreal previousX = 0, previousY = 0;
+	int rangeStart = firstIndex;
+	lineBatch_.lines.clear();
+
+	while(rangeStart < count) {
+
+		qreal xstart = mapX(xx(rangeStart));
+		qreal limit = direction*xstart + xinc;
+
+		// Find the last point within [xstart, xstart+xinc): gallop forward, then bisect.
+		int lo = rangeStart;
+		int hi = rangeStart+1;
+		int step = 1;
+		while(hi < count && direction*mapX(xx(hi)) < limit) {
+			lo = hi;
+			step *= 2;
+			hi = lo + step;
+		}
+		if(hi > count)
+			hi = count;
+		while(hi - lo > 1) {
+			int mid = lo + (hi-lo)/2;
+			if(direction*mapX(xx(mid)) < limit)
+				lo = mid;
+			else
+				hi = mid;
 		}
+		int rangeEnd = lo;
+
+		qreal ystart = mapY(yy(rangeStart));
+		if(rangeStart > firstIndex)
+			addLine(painter, QPointF(previousX, previousY), QPointF(xstart, ystart));
 
-		else {	// do sub-pixel simplification.
-			// Instead of drawing lines between all these data points, we'll just plot the max and min value within every xinc range.  This ensures that if there is noise/jumps within a subsample (xinc) range, we'll still see it on the plot.
+		if(rangeEnd > rangeStart) {
+			qreal minY, maxY;
+			lod->yRange(rangeStart, rangeEnd, minY, maxY);
+			if(minY < maxY)
+				addLine(painter, QPointF(xstart, mapY(minY*yScale + yShift)), QPointF(xstart, mapY(maxY*yScale + yShift)));
 
-			qreal xstart;
-			qreal ystart, ymin, ymax;
+			previousX = mapX(xx(rangeEnd));
+			previousY = mapY(yy(rangeEnd));
+		}
+		else {
+			previousX = xstart;
+			previousY = ystart;
+		}
 
-			xstart = mappedX.at(0);
-			ymin = ymax = ystart = mappedY.at(0);
+		rangeStart = rangeEnd+1;
+	}
 
-			// move through the datapoints along x. (Note that x could be jumping forward or backward here... it's not necessarily sorted)
-			for(int i=1, count = data_->count(); i < count; i++) {
+	flushLines(painter);
+	return true;
+}
 
-				// if within the range around xstart: update max/min to be representative of this range
-				if(fabs(mappedX.at(i) - xstart) < xinc) {
-					qreal mappedYYI = mappedY.at(i);
+void MPlotSeriesBasic::drawMappedLines(QPainter *painter, LineBatch &batch, const qreal *mappedX, const qreal *mappedY, int dataCount, qreal xinc, bool subSample)
+{
+	// should we just draw normally and quickly? Do that if the number of data points is less than the number of x-pixels in the drawing space (or half-pixels, in the conservative case where MPLOT_MAX_LINES_PER_PIXEL = 2).
+	if(!subSample) {
+
+		// One polyline through all the points, split into batches. Non-finite points (ex: NaN y-values) break the line, just like they did when drawing each segment separately.
+		batch.points.clear();
+		for (int i = 0; i < dataCount; i++) {
+			qreal x = mappedX[i], y = mappedY[i];
+			if(!qIsFinite(x) || !qIsFinite(y)) {
+				batch.flushPolyline(painter);
+				continue;
+			}
 
-					if(mappedYYI > ymax)
-						ymax = mappedYYI;
-					if(mappedYYI < ymin)
-						ymin = mappedYYI;
-				}
-				// otherwise draw the lines and move on to next range...
-				// The first line represents everything within the range [xstart, xstart+xinc).  Note that these will all be plotted at same x-pixel.
-				// The second line connects this range to the next.  Note that (if the x-axis point spacing is not uniform) x(i) may be many pixels from xstart, to the left or right. All we know is that it's outside of our 1px range. If it _is_ far outside the range, to get the slope of the connecting line correct, we need to connect it to the last point preceding it. The point (x_(i-1), y_(i-1)) is within the 1px range [xstart, x_(i-1)] represented by the vertical line.
-				// (Brain hurt? imagine a simple example: (0,2) (0,1) (0,0), (5,0).  It should be a vertical line from (0,2) to (0,0), and then a horizontal line from (0,0) to (5,0).  The xinc range is from i=0 (xstart = x(0)) to i=2. The point outside is i=3.
-				// For normal/small datasets where the x-point spacing is >> pixel spacing , what will happen is ymax = ymin = ystart (all the same point), and (x(i), y(i)) is the next point.
-				else {
-					if(ymin != ymax)
-						painter->drawLine(QPointF(xstart, ymin), QPointF(xstart, ymax));
+			batch.addPoint(painter, QPointF(x, y));	// (the next batch continues from the last point)
+		}
+		batch.flushPolyline(painter);
+	}
 
-					painter->drawLine(QPointF(mappedX.at(i-1), mappedY.at(i-1)), QPointF(mappedX.at(i), mappedY.at(i)));
-					//NOT: painter->drawLine(QPointF(xstart, ystart), QPointF(mapX(xx(i)), mapY(yy(i))));
+	else {	// do sub-pixel simplification.
+		// Instead of drawing lines between all these data points, we'll just plot the max and min value within every xinc range.  This ensures that if there is noise/jumps within a subsample (xinc) range, we'll still see it on the plot.
 
-					xstart = mappedX.at(i);
-					ymin = ymax = ystart = mappedY.at(i);
-				}
+		batch.lines.clear();
+
+		qreal xstart;
+		qreal ystart, ymin, ymax;
+
+		xstart = mappedX[0];
+		ymin = ymax = ystart = mappedY[0];
+
+		// move through the datapoints along x. (Note that x could be jumping forward or backward here... it's not necessarily sorted)
+		for(int i=1; i < dataCount; i++) {
+
+			// if within the range around xstart: update max/min to be representative of this range
+			if(fabs(mappedX[i] - xstart) < xinc) {
+				qreal mappedYYI = mappedY[i];
+
+				if(mappedYYI > ymax)
+					ymax = mappedYYI;
+				if(mappedYYI < ymin)
+					ymin = mappedYYI;
 			}
+			// otherwise draw the lines and move on to next range...
+			// The first line represents everything within the range [xstart, xstart+xinc).  Note that these will all be plotted at same x-pixel.
+			// The second line connects this range to the next.  Note that (if the x-axis point spacing is not uniform) x(i) may be many pixels from xstart, to the left or right. All we know is that it's outside of our 1px range. If it _is_ far outside the range, to get the slope of the connecting line correct, we need to connect it to the last point preceding it. The point (x_(i-1), y_(i-1)) is within the 1px range [xstart, x_(i-1)] represented by the vertical line.
+			// (Brain hurt? imagine a simple example: (0,2) (0,1) (0,0), (5,0).  It should be a vertical line from (0,2) to (0,0), and then a horizontal line from (0,0) to (5,0).  The xinc range is from i=0 (xstart = x(0)) to i=2. The point outside is i=3.
+			// For normal/small datasets where the x-point spacing is >> pixel spacing , what will happen is ymax = ymin = ystart (all the same point), and (x(i), y(i)) is the next point.
+			else {
+				if(ymin != ymax)
+					batch.addLine(painter, QPointF(xstart, ymin), QPointF(xstart, ymax));
+
+				batch.addLine(painter, QPointF(mappedX[i-1], mappedY[i-1]), QPointF(mappedX[i], mappedY[i]));
+				//NOT: addLine(painter, QPointF(xstart, ystart), QPointF(mapX(xx(i)), mapY(yy(i))));
+
+				xstart = mappedX[i];
+				ymin = ymax = ystart = mappedY[i];
+			}
+		}
+
+		batch.flushLines(painter);
+	}
+}
+
+void MPlotSeriesBasic::paintCachedLines(QPainter *painter)
+{
+	const QLineF* lines = lineCache_.lines.constData();
+	int lineCount = lineCache_.lines.count();
+	int batchSize = lineBatch_.batchSize > 0 ? lineBatch_.batchSize : lineCount;
+	for(int i = 0; i < lineCount; i += batchSize)
+		painter->drawLines(lines + i, qMin(batchSize, lineCount - i));
+
+	const QPointF* points = lineCache_.polylinePoints.constData();
+	for(int i = 0, n = lineCache_.polylineLengths.count(); i < n; i++) {
+		int length = lineCache_.polylineLengths.at(i);
+		painter->drawPolyline(points, length);
+		points += length;
+	}
+}
+
+void MPlotSeriesBasic::setLineBatchSize(int batchSize)
+{
+	lineBatch_.batchSize = qMax(0, batchSize);
+}
+
+void MPlotSeriesBasic::setGeometryCacheEnabled(bool enabled)
+{
+	geometryCacheEnabled_ = enabled;
+	lineCache_.valid = false;
+	if(!enabled) {
+		lineCache_.lines.clear();
+		lineCache_.polylinePoints.clear();
+		lineCache_.polylineLengths.clear();
+	}
+}
+
+void MPlotSeriesBasic::setMarkerSpritesEnabled(bool enabled)
+{
+	if(markerSpritesEnabled_ == enabled)
+		return;
+
+	markerSpritesEnabled_ = enabled;
+	update();
+}
+
+QImage MPlotSeriesBasic::markerSprite(QPainter *painter) const
+{
+	if(!markerSpritesEnabled_ || !marker_ || !MPlotMarkerSprite::isCacheable(marker_))
+		return QImage();
+
+	// A sprite only looks like the vector marker if it isn't scaled or rotated.  (Even then it's only visually equivalent: drawImage() snaps each sprite to whole device pixels, while the vector marker is drawn at the exact, fractional, center.)...
+	if(painter->deviceTransform().type() > QTransform::TxTranslate)
+		return QImage();
+
+	// ... and there's no point on vector devices (printers, PDF, SVG), where the output should stay scalable.
+	QPaintEngine* engine = painter->paintEngine();
+	if(!engine)
+		return QImage();
+	QPaintEngine::Type engineType = engine->type();
+	if(engineType != QPaintEngine::Raster && engineType != QPaintEngine::OpenGL && engineType != QPaintEngine::OpenGL2)
+		return QImage();
+
+	return MPlotMarkerSprite::sprite(markerShape_, marker_, devicePixelRatio(painter), painter->testRenderHint(QPainter::Antialiasing));
+}
+
+qreal MPlotSeriesBasic::devicePixelRatio(QPainter *painter)
+{
+	qreal ratio = 1.0;
+#if QT_VERSION >= 0x050600
+	if(painter->device())
+		ratio = painter->device()->devicePixelRatioF();
+#elif QT_VERSION >= 0x050100
+	if(painter->device())
+		ratio = painter->device()->devicePixelRatio();
+#else
+	Q_UNUSED(painter)
+#endif
+	return ratio;
+}
+
+void MPlotSeriesBasic::setAsyncRenderingEnabled(bool enabled)
+{
+	if(asyncRenderingEnabled_ == enabled)
+		return;
+
+	asyncRenderingEnabled_ = enabled;
+	if(enabled && !asyncRenderWatcher_) {
+		asyncRenderWatcher_ = new QFutureWatcher<QImage>();
+		QObject::connect(asyncRenderWatcher_, SIGNAL(finished()), signalHandler_, SLOT(onRenderFinished()));
+	}
+	if(!enabled) {
+		asyncImage_ = QImage();
+		asyncImageReady_ = false;
+	}
+	update();
+}
+
+bool MPlotSeriesBasic::AsyncRenderState::operator==(const AsyncRenderState &other) const
+{
+	return dataVersion == other.dataVersion
+			&& xMapping == other.xMapping
+			&& yMapping == other.yMapping
+			&& drawingSize == other.drawingSize
+			&& devicePixelRatio == other.devicePixelRatio
+			&& xinc == other.xinc
+			&& antialiased == other.antialiased
+			&& linePen == other.linePen
+			&& selectedPen == other.selectedPen
+			&& selected == other.selected
+			&& lineBatchSize == other.lineBatchSize
+			&& markerShape == other.markerShape
+			&& markerSize == other.markerSize
+			&& markerPen == other.markerPen
+			&& markerBrush == other.markerBrush
+			&& markerSprites == other.markerSprites
+			&& markerDeduplication == other.markerDeduplication;
+}
+
+bool MPlotSeriesBasic::paintAsync(QPainter *painter)
+{
+	// The image has to line up with the device pixels, and there's no point on vector devices (printers, PDF, SVG).
+	if(painter->deviceTransform().type() > QTransform::TxTranslate)
+		return false;
+	QPaintEngine* engine = painter->paintEngine();
+	if(!engine)
+		return false;
+	QPaintEngine::Type engineType = engine->type();
+	if(engineType != QPaintEngine::Raster && engineType != QPaintEngine::OpenGL && engineType != QPaintEngine::OpenGL2)
+		return false;
+
+	AsyncRenderState state;
+	state.dataVersion = asyncDataVersion_;
+	state.xMapping = xAxisTarget()->mapping();
+	state.yMapping = yAxisTarget()->mapping();
+	state.drawingSize = QSizeF(xAxisTarget()->drawingSize().width(), yAxisTarget()->drawingSize().height());
+	state.devicePixelRatio = devicePixelRatio(painter);
+	state.xinc = 1.0 / MPLOT_MAX_LINES_PER_PIXEL;	// (the painter isn't scaled)
+	state.antialiased = painter->testRenderHint(QPainter::Antialiasing);
+	state.linePen = linePen_;
+	state.selectedPen = selectedPen_;
+	state.selected = selected();
+	state.lineBatchSize = lineBatch_.batchSize;
+	state.markerShape = marker_ ? markerShape_ : MPlotMarkerShape::None;
+	state.markerSize = marker_ ? marker_->size() : 0;
+	state.markerPen = marker_ ? marker_->pen() : QPen();
+	state.markerBrush = marker_ ? marker_->brush() : QBrush();
+	state.markerSprites = markerSpritesEnabled_;
+	state.markerDeduplication = markerDeduplicationEnabled_;
+
+	// Start a new render if the image is out of date.  If one is running already, onRenderFinished() will ask for another paint, and we'll check again then.
+	if(!(asyncImageReady_ && asyncImageState_ == state) && !asyncRenderRunning_) {
+
+		AsyncRenderJob job;
+		job.state = state;
+		if(data_ && data_->count() > 0) {
+			int firstIndex, lastIndex;
+			visibleIndexRange(firstIndex, lastIndex);
+			job.x.resize(lastIndex-firstIndex+1);
+			job.y.resize(lastIndex-firstIndex+1);
+			xxValues(unsigned(firstIndex), unsigned(lastIndex), job.x.data());
+			yyValues(unsigned(firstIndex), unsigned(lastIndex), job.y.data());
 		}
+		job.sprite = markerSprite(painter);
+
+		asyncRunningState_ = state;
+		asyncRenderRunning_ = true;
+		asyncRenderWatcher_->setFuture(QtConcurrent::run(&MPlotSeriesBasic::renderAsyncJob, job));
 	}
+
+	if(!asyncImage_.isNull())
+		painter->drawImage(QRectF(QPointF(0, 0), asyncImageState_.drawingSize), asyncImage_, QRectF(asyncImage_.rect()));
+
+	return true;
+}
+
+QImage MPlotSeriesBasic::renderAsyncJob(const AsyncRenderJob &job)
+{
+	const AsyncRenderState& state = job.state;
+	qreal ratio = state.devicePixelRatio;
+	int width = int(ceil(state.drawingSize.width()*ratio));
+	int height = int(ceil(state.drawingSize.height()*ratio));
+	if(width <= 0 || height <= 0)
+		return QImage();
+
+	QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+	image.fill(Qt::transparent);
+
+	int count = job.x.count();
+	if(count > 0) {
+		QPainter painter(&image);
+		painter.setRenderHint(QPainter::Antialiasing, state.antialiased);
+		painter.scale(ratio, ratio);
+
+		QVector<qreal> mappedX = QVector<qreal>(count);
+		QVector<qreal> mappedY = QVector<qreal>(count);
+		transformAndMapValues(count, job.x.constData(), 1, 1.0, 0.0, state.xMapping, mappedX.data());
+		transformAndMapValues(count, job.y.constData(), 1, 1.0, 0.0, state.yMapping, mappedY.data());
+
+		// Same order as paint(): markers first, then the lines.
+		if(state.markerShape != MPlotMarkerShape::None) {
+			// Culling re-arranges the points, so it needs its own copy.
+			QVector<qreal> markerX = mappedX;
+			QVector<qreal> markerY = mappedY;
+			int firstMarker = 0;
+			if(state.markerDeduplication && !job.sprite.isNull()) {
+				QVector<quint32> occupancy;
+				firstMarker = cullHiddenMarkers(painter.deviceTransform(), 1.0, state.drawingSize, job.sprite, occupancy, markerX.data(), markerY.data(), count);
+			}
+
+			painter.setPen(state.markerPen);
+			painter.setBrush(state.markerBrush);
+			if(!job.sprite.isNull())
+				drawMarkers(&painter, markerX.constData(), markerY.constData(), firstMarker, count, job.sprite, 0);
+			else {
+				// The series' own marker can change while we're drawing; use a copy.
+				MPlotAbstractMarker* marker = MPlotMarker::create(state.markerShape, state.markerSize, state.markerPen, state.markerBrush);
+				if(marker)
+					drawMarkers(&painter, markerX.constData(), markerY.constData(), firstMarker, count, QImage(), marker);
+				delete marker;
+			}
+		}
+
+		LineBatch batch;
+		batch.batchSize = state.lineBatchSize;
+		bool subSample = count >= state.drawingSize.width()/state.xinc;
+		if(state.selected) {
+			painter.setPen(state.selectedPen);
+			drawMappedLines(&painter, batch, mappedX.constData(), mappedY.constData(), count, state.xinc, subSample);
+		}
+		painter.setPen(state.linePen);
+		drawMappedLines(&painter, batch, mappedX.constData(), mappedY.constData(), count, state.xinc, subSample);
+	}
+
+#if QT_VERSION >= 0x050100
+	image.setDevicePixelRatio(ratio);
+#endif
+	return image;
+}
+
+void MPlotSeriesBasic::onRenderFinished()
+{
+	asyncRenderRunning_ = false;
+	if(!asyncRenderingEnabled_)
+		return;
+
+	asyncImage_ = asyncRenderWatcher_->result();
+	asyncImageState_ = asyncRunningState_;
+	asyncImageReady_ = true;
+	update();
+}
+
+void MPlotSeriesBasic::setMarkerDeduplicationEnabled(bool enabled)
+{
+	if(markerDeduplicationEnabled_ == enabled)
+		return;
+
+	markerDeduplicationEnabled_ = enabled;
+	update();
+}
+
+int MPlotSeriesBasic::cullHiddenMarkers(QPainter *painter, const QImage &sprite, qreal *x, qreal *y, int count)
+{
+	return cullHiddenMarkers(painter->deviceTransform(), devicePixelRatio(painter), QSizeF(xAxisTarget()->drawingSize().width(), yAxisTarget()->drawingSize().height()), sprite, markerOccupancy_, x, y, count);
+}
+
+int MPlotSeriesBasic::cullHiddenMarkers(const QTransform &wt, qreal ratio, const QSizeF &drawingSize, const QImage &sprite, QVector<quint32> &occupancyBuffer, qreal *x, qreal *y, int count)
+{
+	// Only sprites land on whole device pixels, and only when the painter is just translated.  (See drawMarkers().)
+	if(sprite.isNull() || wt.type() > QTransform::TxTranslate)
+		return 0;
+
+	qreal spriteRatio = 1.0;
+#if QT_VERSION >= 0x050100
+	spriteRatio = sprite.devicePixelRatio();
+#endif
+	qreal halfSize = sprite.width()/spriteRatio/2;
+
+	// Device pixel coordinates: p = (drawing + d) * ratio.
+	qreal dx = wt.dx()*ratio;
+	qreal dy = wt.dy()*ratio;
+
+	// The occupancy grid covers the sprite origins of markers centered in the plot area.  Markers outside of it are never culled.
+	int left = int(floor(dx - halfSize*ratio)) - 1;
+	int top = int(floor(dy - halfSize*ratio)) - 1;
+	int width = int(ceil(dx + (drawingSize.width() - halfSize)*ratio)) + 2 - left;
+	int height = int(ceil(dy + (drawingSize.height() - halfSize)*ratio)) + 2 - top;
+	if(width <= 0 || height <= 0 || qint64(width)*height > (qint64(1) << 28))
+		return 0;
+
+	int wordCount = int((qint64(width)*height + 31)/32);
+	if(occupancyBuffer.size() < wordCount)
+		occupancyBuffer.resize(wordCount);
+	quint32* occupancy = occupancyBuffer.data();
+	memset(occupancy, 0, size_t(wordCount)*sizeof(quint32));
+
+	// Markers are drawn from the last point to the first, so the one with the lowest index ends up on top.  Walk from the first point, keeping only the top copy at each device pixel, and compacting the survivors towards the beginning.
+	int kept = 0;
+	for(int i = 0; i < count; i++) {
+
+		qreal xi = x[i];
+		qreal yi = y[i];
+		if(!qIsFinite(xi) || !qIsFinite(yi))
+			continue;
+
+		// The device pixel where drawImage() puts the top-left corner of the sprite: the rounded corner of QRectF(x-halfSize, y-halfSize, ...).
+		qreal ox = (xi - halfSize)*ratio + dx;
+		qreal oy = (yi - halfSize)*ratio + dy;
+		if(ox >= left && ox < left+width-1 && oy >= top && oy < top+height-1) {
+			qint64 bit = qint64(qRound(oy) - top)*width + qint64(qRound(ox) - left);
+			quint32 mask = quint32(1) << (bit & 31);
+			quint32& word = occupancy[bit >> 5];
+			if(word & mask)
+				continue;
+			word |= mask;
+		}
+
+		x[kept] = xi;
+		y[kept] = yi;
+		kept++;
+	}
+
+	// Move the survivors to the end of the arrays, where drawMarkers() expects them.
+	int first = count - kept;
+	memmove(x + first, x, size_t(kept)*sizeof(qreal));
+	memmove(y + first, y, size_t(kept)*sizeof(qreal));
+	return first;
+}
+
+void MPlotSeriesBasic::LineBatch::flushLines(QPainter *painter)
+{
+	if(!lines.isEmpty()) {
+		if(painter)
+			painter->drawLines(lines.constData(), lines.count());
+		if(record)
+			record->lines += lines;
+	}
+	lines.clear();
+}
+
+void MPlotSeriesBasic::LineBatch::flushPolyline(QPainter *painter)
+{
+	if(points.count() > 1) {
+		if(painter)
+			painter->drawPolyline(points.constData(), points.count());
+		if(record) {
+			record->polylinePoints += points;
+			record->polylineLengths << points.count();
+		}
+	}
+	points.clear();
 }
 
 void MPlotSeriesBasic::paintMarkers(QPainter* painter) {
 
 	if(data_ && marker_) {
 
-		int dataCount = data_->count();
-		QVector<qreal> x = QVector<qreal>(dataCount);
-		QVector<qreal> y = QVector<qreal>(dataCount);
+		if(data_->count() == 0)
+			return;
 
-		xxValues(0, dataCount-1, x.data());
-		yyValues(0, dataCount-1, y.data());
+		// Only the markers inside the visible x range (and their neighbours) need to be drawn.
+		int firstIndex, lastIndex;
+		visibleIndexRange(firstIndex, lastIndex, exposedRect_);
+		int dataCount = lastIndex-firstIndex+1;
 
 		QVector<qreal> mappedX = QVector<qreal>(dataCount);
 		QVector<qreal> mappedY = QVector<qreal>(dataCount);
 
-		mapXValues(mappedX.size(), x.constData(), mappedX.data());
-		mapYValues(mappedY.size(), y.constData(), mappedY.data());
+		mapXXValues(unsigned(firstIndex), unsigned(lastIndex), mappedX.data());
+		mapYYValues(unsigned(firstIndex), unsigned(lastIndex), mappedY.data());
+
+		QImage sprite = markerSprite(painter);
 
-		for (int i = data_->count()-1; i >= 0; i--){
+		// Markers are drawn from the last point to the first, down to index firstMarker.  Hidden markers can only be culled exactly when drawing sprites.
+		int firstMarker = 0;
+		if(markerDeduplicationEnabled_ && !sprite.isNull())
+			firstMarker = cullHiddenMarkers(painter, sprite, mappedX.data(), mappedY.data(), dataCount);
 
-			painter->translate(mappedX.at(i), mappedY.at(i));
-			marker_->paint(painter);
-			painter->translate(-mappedX.at(i), -mappedY.at(i));
+		drawMarkers(painter, mappedX.constData(), mappedY.constData(), firstMarker, dataCount, sprite, marker_);
+	}
+}
+
+void MPlotSeriesBasic::drawMarkers(QPainter *painter, const qreal *x, const qreal *y, int first, int count, const QImage &sprite, MPlotAbstractMarker *marker)
+{
+	if(!sprite.isNull()) {
+		// Each marker is just a copy of the pre-rendered image, centered on the point.
+		qreal spriteRatio = 1.0;
+#if QT_VERSION >= 0x050100
+		spriteRatio = sprite.devicePixelRatio();
+#endif
+		qreal spriteSize = sprite.width()/spriteRatio;
+		qreal halfSize = spriteSize/2;
+		QRectF source = QRectF(sprite.rect());
+
+		for (int i = count-1; i >= first; i--) {
+			qreal xi = x[i];
+			qreal yi = y[i];
+			if(qIsFinite(xi) && qIsFinite(yi))
+				painter->drawImage(QRectF(xi-halfSize, yi-halfSize, spriteSize, spriteSize), sprite, source);
 		}
+		return;
+	}
+
+	for (int i = count-1; i >= first; i--){
+
+		painter->translate(x[i], y[i]);
+		marker->paint(painter);
+		painter->translate(-x[i], -y[i]);
 	}
 }
 
@@ -466,7 +1412,73 @@ void MPlotSeriesBasic::setSelected(bool selected) {
 
 // All the specific re-drawing we need to do when the data changes (or a new model is set) is contained in update().
 void MPlotSeriesBasic::onDataChanged() {
+	lineCache_.valid = false;
+	asyncDataVersion_++;
 	update();
 }
 
+void MPlotSeriesBasic::onAxisScaleChanged()
+{
+	lineCache_.valid = false;
+	asyncDataVersion_++;
+}
+
+void MPlotSeriesBasic::onDataRangeChanged(int firstIndex, int lastIndex, bool appended)
+{
+	lineCache_.valid = false;
+	asyncDataVersion_++;
+	if(asyncRenderingEnabled_) {
+		update();	// the whole image is re-drawn anyway
+		return;
+	}
+
+	int count = data_ ? data_->count() : 0;
+	if(!xAxisTarget() || !yAxisTarget() || lastIndex < firstIndex || lastIndex >= count) {
+		update();
+		return;
+	}
+
+	// When the curve is sub-sampled, changing a point in the middle can change how all the points after it are grouped.  Appending only adds groups at the end.
+	if(!appended) {
+		int visibleFirst, visibleLast;
+		visibleIndexRange(visibleFirst, visibleLast);
+		if(visibleLast-visibleFirst+1 >= xAxisTarget()->drawingSize().width()*MPLOT_MAX_LINES_PER_PIXEL) {
+			update();
+			return;
+		}
+	}
+
+	// The changed points, and the lines to their neighbours.  The x-values are sorted (or these were appended), so the old positions were within the same x range.  We don't know the old y-values, so the whole height is re-drawn.
+	int first = qMax(0, firstIndex-1);
+	int last = qMin(count-1, lastIndex+1);
+	if(last-first+1 > count/2) {
+		update();
+		return;
+	}
+
+	QVector<qreal> mappedX = QVector<qreal>(last-first+1);
+	mapXXValues(unsigned(first), unsigned(last), mappedX.data());
+
+	qreal left = std::numeric_limits<qreal>::infinity();
+	qreal right = -std::numeric_limits<qreal>::infinity();
+	for(int i = 0, n = mappedX.count(); i < n; i++) {
+		qreal x = mappedX.at(i);
+		if(qIsFinite(x)) {
+			left = qMin(left, x);
+			right = qMax(right, x);
+		}
+	}
+	if(!(left <= right)) {
+		update();
+		return;
+	}
+
+	qreal margin = MPLOT_SELECTION_LINEWIDTH + linePen_.widthF() + 2;
+	if(marker_)
+		margin += marker_->size() + marker_->pen().widthF();
+
+	QRectF all = boundingRect();
+	update(QRectF(left-margin, all.top(), right-left+2*margin, all.height()));
+}
+
 #endif
@@ -6,9 +6,14 @@
 #include "MPlot/MPlotMarker.h"
 #include "MPlot/MPlotItem.h"
 #include "MPlot/MPlotSeriesData.h"
+#include "MPlot/MPlotSegmentIndex.h"
 
 #include <QPen>
 #include <QBrush>
+#include <QVector>
+#include <QLineF>
+#include <QPointF>
+#include <QFutureWatcher>
 class QPainter;
 
 
@@ -16,6 +21,12 @@ class QPainter;
 /// When the number of points exceeds this, we simply return the bounding box instead of the exact shape of the plot.  Makes selection less precise, but faster.
 #define MPLOT_EXACTSHAPE_POINT_LIMIT 10000
 
+/// The number of values that mapXXValues() and mapYYValues() copy out of a model at once, when the model doesn't provide direct access. Small enough to stay in the L1 cache.
+#define MPLOT_MAPPING_CHUNK_SIZE 1024
+
+/// The number of points that MPlotAbstractSeries::nearestPointIndex() checks (or rules out) at once, when the model's x-values are sorted.
+#define MPLOT_NEARESTPOINT_BLOCK_SIZE 256
+
 class MPlotAbstractSeries;
 
 /// This class receives and processes signals for MPlotAbstractSeriesData. You should never need to use it directly.
@@ -31,6 +42,14 @@ protected:
 protected slots:
 	/// Handles changes to the data in the series.
 	void onDataChanged();
+	/// Handles changes to the values of the points from \c first to \c last.
+	void onDataRangeChanged(int first, int last);
+	/// Handles points appended to the data.
+	void onPointsAppended(int n);
+	/// Handles points removed from the front of the data.
+	void onPointsRemovedFront(int n);
+	/// Handles the end of a background render started by the series.
+	void onRenderFinished();
 
 protected:
 	/// Pointer to the series the signal handler is managing.
@@ -76,6 +95,8 @@ public:
 	virtual MPlotAbstractMarker* marker() const;
 	/// Sets a marker to the go with each point that makes up the series.
 	virtual void setMarker(MPlotMarkerShape::Shape shape, qreal size = 6, const QPen& pen = QPen(QColor(Qt::red)), const QBrush& brush = QBrush());
+	/// Returns the shape of the current marker (MPlotMarkerShape::None if there isn't one).
+	MPlotMarkerShape::Shape markerShape() const { return markerShape_; }
 
 
 	/// Sets this series to view the model in 'data'.  If the series should take ownership of the model (ie: delete the model when it gets deleted), set \c ownsModel to true. (If a model was previously set with \c ownsModel = true, then this function will delete the old model.)
@@ -135,24 +156,59 @@ public:
 	/// Returns the shape of the series as a QPainterPath. Contains all the information about drawing complex shapes.
 	virtual QPainterPath shape() const;
 
+	/// Handles the model changes that were put off while the plot limits its update rate (see MPlot::setMaximumUpdateRate()).  Several changes that happened since the last frame are handled as one.
+	virtual void flushDeferredDataChange();
+
+	/// Finds the point closest to \c drawingPosition (in drawing coordinates), and closer than \c maxDistance (a negative value means no limit).  Returns its index in the model(), or -1 if there isn't one.  If \c distance is not 0, it's set to the distance to that point, in drawing coordinates.
+	/*! When the model's x-values are sorted (MPlotAbstractSeriesData::isXMonotonic()), the search starts at the x-value under \c drawingPosition (found with a binary search), and moves outwards in blocks of MPLOT_NEARESTPOINT_BLOCK_SIZE points, until the horizontal distance alone is further than the closest point found.  If the model also has a min/max index (MPlotAbstractSeriesData::setLevelOfDetailEnabled()), blocks whose y-range is too far away are skipped without reading their points, so that many points in the same pixel column don't slow it down.  Otherwise, every point is checked.
+
+	  Only call when the series has both axis targets. */
+	int nearestPointIndex(const QPointF& drawingPosition, qreal maxDistance = -1, qreal* distance = 0) const;
+	/// Returns the value of point \c index as it is plotted: with the transformation, normalization and offset applied.  Only call when model() is valid, and \c index < model().count().
+	QPointF transformedValue(int index) const { return QPointF(xx(unsigned(index)), yy(unsigned(index))); }
+
 
 private: // "slots"
 	/// This implementation is called first when the source data changes. It flags the bounding rectangle for an update, warns the scene of geometry changes, and emits a boundsChanged signal to attached plots. Then it calls onDataChanged(), which can be re-implemented by subclasses.
 	void onDataChangedPrivate();
+	/// Called for the detailed change notifications from the model (MPlotSeriesDataSignalSource::dataRangeChanged(), pointsAppended(), and pointsRemovedFront()).  If the bounds of the data haven't changed, there's no geometry change or boundsChanged() signal (and so no re-autoscale); subclasses are asked to redraw only the points from \c first to \c last with onDataRangeChanged().  Otherwise, this falls back to onDataChangedPrivate().  Either way, the generic dataChanged() that follows is ignored.
+	void onDetailedDataChangePrivate(int first, int last, bool appended);
+	/// Called for the generic dataChanged() notification from the model.  Calls onDataChangedPrivate(), unless the plot limits its update rate; then it waits for flushDeferredDataChange().
+	void onModelDataChangedPrivate();
+	/// The part of onDetailedDataChangePrivate() that decides between onDataRangeChanged() and onDataChangedPrivate().
+	void handleDetailedDataChange(int first, int last, bool appended);
 
 protected: // "slots"
 	/// This virtual function is called by the base class to let subclasses know when the internal data has changed, and let's them handle this however they need to.
 	virtual void onDataChanged() = 0;
+	/// Called (on the GUI thread) when a background render started by a subclass has finished.  The base class implementation does nothing.
+	virtual void onRenderFinished() {}
+	/// This virtual function is called by the base class when the bounds of the data are unchanged, and only the points from \c firstIndex to \c lastIndex (inclusive) have changed.  \c appended is true if those points were just appended at the end.  If \c lastIndex < \c firstIndex, the change can't be located (ex: points were removed).  The base class implementation calls onDataChanged().
+	virtual void onDataRangeChanged(int firstIndex, int lastIndex, bool appended);
 
 protected:
 	/// Helper function to return a the transformed, normalized, offsetted x value. (Only call when model() is valid, and i<model().count()!)
 	qreal xx(unsigned i) const { return data_->x(i)*sx_+dx_+offset_.x(); }
 	/// Helper function to return a the transformed, normalized, offsetted x value. (Only call when model() is valid, and i<model().count()!)
 	qreal yy(unsigned i) const { return data_->y(i)*sy_+dy_+offset_.y(); }
-	/// Helper function that sets outputValues to a transformed, normalized, offsetted value.
+	/// Helper function that sets outputValues to a transformed, normalized, offsetted value.  If the model provides direct access (MPlotAbstractSeriesData::xSpan()), the values are read straight from the model's memory, without an intermediate copy.
 	void xxValues(unsigned start, unsigned end, qreal *outputValues) const;
 	/// Helper function that sets output values to a transformed, normalized, offsetted value.
 	void yyValues(unsigned start, unsigned end, qreal *outputValues) const;
+	/// Helper function that sets outputValues to the drawing coordinates of the transformed, normalized, offsetted x values. This is equivalent to xxValues() followed by mapXValues(), but reads the model once and writes the output once. Only call when xAxisTarget() is valid.
+	void mapXXValues(unsigned start, unsigned end, qreal *outputValues) const;
+	/// Helper function that sets outputValues to the drawing coordinates of the transformed, normalized, offsetted y values. This is equivalent to yyValues() followed by mapYValues(). Only call when yAxisTarget() is valid.
+	void mapYYValues(unsigned start, unsigned end, qreal *outputValues) const;
+	/// Helper function for mapXXValues() and mapYYValues(): applies the series transform (\c scale, \c shift) and then the axis \c mapping to \c size values read from input[i*stride].
+	static void transformAndMapValues(int size, const qreal* input, int stride, qreal scale, qreal shift, const MPlotAxisMapping& mapping, qreal* outputValues);
+	/// Helper function for xxValues() and yyValues(): sets outputValues[i] = input[i*stride]*scale + shift.  \c input may be the same as \c outputValues when \c stride is 1.
+	static void transformValues(int size, const qreal* input, int stride, qreal scale, qreal shift, qreal* outputValues);
+
+	/// Helper function for painting: finds the range of points (\c firstIndex to \c lastIndex, inclusive) that must be drawn to cover the visible part of the x axis.  When the model's x-values are sorted (MPlotAbstractSeriesData::isXMonotonic()), this is the points inside the axis range plus one point on each side, found with MPlotAbstractSeriesData::indexRangeForX().  Otherwise, it's all the points.  Only call when model() is valid and has at least one point.
+	/*! If \c exposedRect is valid (in drawing coordinates), only the points inside its horizontal extent are included (plus one on each side). */
+	void visibleIndexRange(int& firstIndex, int& lastIndex, const QRectF& exposedRect = QRectF()) const;
+	/// Helper function for nearestPointIndex(): checks the points from \c first to \c last (inclusive), and updates \c best and \c bestSquared (the squared distance) if one of them is closer to \c position.  If \c lod is not 0, the points are only read when their y-range, together with \c xDistanceSquared (the smallest squared horizontal distance of any of them), could be closer.  \c mappedX and \c mappedY must have room for the points.
+	void nearestPointInRange(int first, int last, const QPointF& position, qreal xDistanceSquared, const MPlotMinMaxPyramid* lod, int& best, qreal& bestSquared, qreal* mappedX, qreal* mappedY) const;
 
 	/// Helper function that sets a default look and feel to the plot.
 	virtual void setDefaults();
@@ -161,6 +217,8 @@ protected:
 	QPen linePen_, selectedPen_;
 	/// Pointer to the marker used on each point of the series.
 	MPlotAbstractMarker* marker_;
+	/// The shape that marker_ was created with.
+	MPlotMarkerShape::Shape markerShape_;
 
 	/// Holds the name of the series.
 	QString name_;
@@ -174,6 +232,18 @@ protected:
 	mutable QRectF cachedDataRect_;
 	/// If true, indicates that the cachedDataRect_ is stale. Set true when the model indicates data changed; set false when the cachedDataRect_ is updated inside boundingRect().
 	mutable bool dataChangedUpdateNeeded_;
+	/// The model's boundingRect() when cachedDataRect_ was last computed.  Used to tell whether a change to the data changed its bounds.
+	mutable QRectF cachedModelRect_;
+	/// True if a detailed change notification has been handled, so the generic dataChanged() that follows should be ignored.
+	bool detailedDataChangeHandled_;
+	/// True if a model change that needs the full onDataChangedPrivate() is waiting for the next frame.
+	bool deferredFullChange_;
+	/// True if a detailed change (deferredFirst_ to deferredLast_) is waiting for the next frame.  If deferredLast_ < deferredFirst_, it can't be located.
+	bool deferredRangeChange_;
+	/// The range of points changed by the deferred detailed changes.
+	int deferredFirst_, deferredLast_;
+	/// True if all the deferred detailed changes were appends.
+	bool deferredAppended_;
 
 
 	// transformation and normalization
@@ -201,6 +271,9 @@ protected:
 /// The value that makes sense here is 1 (since you can't see any more... they would just look like vertical lines on top of each other anyway.)  When drawing anti-aliased, changing this to 2 makes smoother plots.
 #define MPLOT_MAX_LINES_PER_PIXEL 2.0
 
+/// By default, MPlotSeriesBasic submits lines to QPainter in batches of this many.  Smaller batches keep the raster engine's stroker efficient; larger ones reduce per-call overhead.
+#define MPLOT_DEFAULT_LINE_BATCH_SIZE 4096
+
 /// If you're going to add a lot of points to the model (without caring about updates in between), recommend this for performance reasons:
 /*!
  MPlotSeriesBasic series;
@@ -211,6 +284,7 @@ protected:
  */
 
 /// MPlotSeriesBasic provides one drawing implementation for a 2D plot curve.  It is optimized to efficiently draw curves with 1,000,000+ data points along the x-axis, by only drawing as many lines as would be visible.
+/*! For much larger datasets with sorted x-values, enable the model's min/max index (MPlotAbstractSeriesData::setLevelOfDetailEnabled()). Then the cost of drawing depends on the number of pixel columns, rather than on the number of points. */
 
 class MPLOTSHARED_EXPORT MPlotSeriesBasic : public MPlotAbstractSeries {
 
@@ -238,12 +312,211 @@ public:
 	/// re-implemented from MPlotItem base to draw an update if we're now selected (with our selection highlight)
 	virtual void setSelected(bool selected = true);
 
+	/// Re-implemented to test \c region against the lines as they are drawn, using a spatial index over them (see MPlotSegmentIndex).  Unlike shape(), this is exact for any number of points, and only costs as much as the number of lines near \c region.
+	virtual bool hitTest(const QRectF& region);
+	/// Finds the drawn line closest to \c point (in drawing coordinates), within \c maxDistance.  Returns false if there isn't one.  Otherwise returns true, and sets \c segment and \c distance (if not 0) to that line and its distance from \c point.
+	bool nearestDrawnSegment(const QPointF& point, qreal maxDistance, QLineF* segment = 0, qreal* distance = 0);
+
+	/// Returns the maximum number of lines (or polyline segments) submitted to QPainter in one call. 0 means no limit.
+	int lineBatchSize() const { return lineBatch_.batchSize; }
+	/// Sets the maximum number of lines (or polyline segments) submitted to QPainter in one call.  Lines are always drawn in batches (instead of one drawLine() call per segment), but very long polylines can be slow to stroke in the raster engine, so they are split into batches of this size.  Use 0 to draw everything in a single call.  The default is MPLOT_DEFAULT_LINE_BATCH_SIZE.
+	void setLineBatchSize(int batchSize);
+
+	/// Returns true if markers are drawn by copying a pre-rendered image of the marker (see MPlotMarkerSprite), whenever possible.
+	bool markerSpritesEnabled() const { return markerSpritesEnabled_; }
+	/// Enables or disables drawing markers from pre-rendered images.  This is much faster than painting each marker as a vector shape, and it's used automatically when the painter is only translated (not scaled or rotated), is drawing to a raster or OpenGL device, and the marker has solid pens and brushes.  Otherwise (or if disabled), each marker is painted with MPlotAbstractMarker::paint().  Enabled by default.
+	void setMarkerSpritesEnabled(bool enabled);
+
+	/// Returns true if markers completely covered by an identical copy drawn on top of them are skipped.
+	bool markerDeduplicationEnabled() const { return markerDeduplicationEnabled_; }
+	/// Returns true if the drawing-coordinate lines are kept between paints.
+	bool geometryCacheEnabled() const { return geometryCacheEnabled_; }
+	/// Enables or disables keeping the (sub-sampled) lines, in drawing coordinates, from one paint to the next.  When a paint isn't caused by a change to the data or the axis scales (ex: a cursor moving over the plot, a legend update, or the selection highlight, which draws the lines twice), the lines are drawn again from the cache, without reading or mapping any points.  The cache is a few lines per pixel of plot width.  Enabled by default.
+	void setGeometryCacheEnabled(bool enabled);
+
+	/// Returns true if the series is drawn into an image on a background thread.
+	bool asyncRenderingEnabled() const { return asyncRenderingEnabled_; }
+	/// Enables or disables drawing the series on a background thread.  Painting a very large series can take long enough to make the user interface stall.  With this enabled, paint() only draws the last image finished by a background render, and when anything the image depends on has changed (the data, the axis scales, the size or the style), it starts a new render and shows the old image until the new one is ready.
+	/*! The render works on a copy of the visible points, so the model can keep changing in the meantime.  Copying the points is still done during paint(), but it is much cheaper than drawing them.
+
+	  Only used when painting to the screen or to an image, without scaling or rotation; otherwise (ex: when printing), the series is drawn directly.  Until the first image is ready, nothing is drawn.  Disabled by default.
+	  */
+	void setAsyncRenderingEnabled(bool enabled);
+
+	/// Enables or disables skipping markers that are completely covered by an identical copy drawn on top of them.  For dense scatter plots with far more points than pixels, this makes drawing the markers depend on the number of visible pixels rather than the number of points.
+	/*! Culling only happens when markers are drawn from sprites (see setMarkerSpritesEnabled()): drawImage() puts each sprite at a whole device pixel, so markers whose sprites land on the same pixel draw the same image in the same place, and only the top one is kept.  The result is the same at the pixel level when the sprite has no partially transparent pixels (ex: an opaque marker without antialiasing).  Otherwise, stacked copies no longer blend with each other, so antialiased edges and translucent markers come out lighter where points pile up.  Disabled by default.
+	  */
+	void setMarkerDeduplicationEnabled(bool enabled);
+
 protected: //"slots"
 
 	/// Handle implementation-specific drawing updates
 	virtual void onDataChanged();
+	/// Re-implemented to redraw only the area covered by the changed points (and the lines to their neighbours), when possible.
+	virtual void onDataRangeChanged(int firstIndex, int lastIndex, bool appended);
+	/// Re-implemented to drop the cached lines.
+	virtual void onAxisScaleChanged();
+	/// Shows the image from a finished background render.
+	virtual void onRenderFinished();
 
 protected:
+	/// The lines drawn by the last paintLines() that covered everything visible, and what they were drawn from.
+	struct LineCache {
+		/// False if the data has changed since the lines were recorded.
+		bool valid;
+		/// The axis scale mappings, sub-sampling step, plot width, and range of points that the lines were drawn with.
+		MPlotAxisMapping xMapping, yMapping;
+		qreal xinc, drawingWidth;
+		int firstIndex, lastIndex;
+		/// The separate line segments, in the order they were drawn.
+		QVector<QLineF> lines;
+		/// The points of all the polylines, one after the other, and the number of points in each one.
+		QVector<QPointF> polylinePoints;
+		QVector<int> polylineLengths;
+	};
+
+	/// Queues lines and polyline points so that they can be drawn with a few QPainter calls, and copies what was drawn into \c record if it's set.  With a null painter, the lines are only recorded.  paint() uses lineBatch_; background renders use their own.
+	class LineBatch {
+	public:
+		LineBatch() : batchSize(MPLOT_DEFAULT_LINE_BATCH_SIZE), record(0) {}
+
+		/// Queues a line to be drawn, and draws the queue if it's full.
+		void addLine(QPainter* painter, const QPointF& p1, const QPointF& p2) {
+			lines.append(QLineF(p1, p2));
+			if(batchSize > 0 && lines.count() >= batchSize)
+				flushLines(painter);
+		}
+		/// Adds a point to the current polyline, and draws it if it's full.  The next polyline continues from the last point.
+		void addPoint(QPainter* painter, const QPointF& point) {
+			points.append(point);
+			if(batchSize > 0 && points.count() > batchSize) {
+				flushPolyline(painter);
+				points.append(point);
+			}
+		}
+		/// Draws all the queued lines with one drawLines() call.
+		void flushLines(QPainter* painter);
+		/// Draws the queued points as one polyline.
+		void flushPolyline(QPainter* painter);
+
+		/// The maximum number of lines (or polyline segments) per QPainter call, or 0 for no limit.
+		int batchSize;
+		/// The queued lines.
+		QVector<QLineF> lines;
+		/// The queued polyline points.
+		QVector<QPointF> points;
+		/// If not 0, everything drawn is also added here.
+		LineCache* record;
+	};
+
+	/// Everything a background render depends on, except for the points themselves.  The last finished image is up to date while this doesn't change.
+	struct AsyncRenderState {
+		/// Compares every member.
+		bool operator==(const AsyncRenderState& other) const;
+
+		/// Incremented every time the data changes.
+		quint64 dataVersion;
+		/// How points are mapped to drawing coordinates, and the size of the drawing area.
+		MPlotAxisMapping xMapping, yMapping;
+		QSizeF drawingSize;
+		/// The device pixels per drawing unit, and the sub-sampling step (see paintLines()).
+		qreal devicePixelRatio, xinc;
+		bool antialiased;
+		/// The look of the lines.
+		QPen linePen, selectedPen;
+		bool selected;
+		int lineBatchSize;
+		/// The look of the markers.
+		MPlotMarkerShape::Shape markerShape;
+		qreal markerSize;
+		QPen markerPen;
+		QBrush markerBrush;
+		bool markerSprites, markerDeduplication;
+	};
+
+	/// A self-contained copy of what a background render needs, which doesn't refer to the series or its model.
+	struct AsyncRenderJob {
+		AsyncRenderState state;
+		/// The transformed (xx() and yy()) values of the visible points.
+		QVector<qreal> x, y;
+		/// The pre-rendered marker, or a null image to draw markers as vector shapes.
+		QImage sprite;
+	};
+
+	/// Helper function for paint(): if background rendering can be used with \c painter, draws the last finished image, starts a new render if needed, and returns true.  Returns false if the series must be drawn directly.
+	bool paintAsync(QPainter* painter);
+	/// Draws everything in \c job into an image.  Runs on a worker thread.
+	static QImage renderAsyncJob(const AsyncRenderJob& job);
+
+	/// Helper function for paintLines(): draws the lines between points \c firstIndex and \c lastIndex, sub-sampled to \c xinc if there are more points than that.
+	void paintVisibleLines(QPainter* painter, qreal xinc, int firstIndex, int lastIndex);
+	/// Helper function for paintLines(): draws the lines recorded in lineCache_.
+	void paintCachedLines(QPainter* painter);
+	/// Returns true if lineCache_ holds the lines between points \c firstIndex and \c lastIndex, sub-sampled to \c xinc, for the current axis scales.
+	bool lineCacheMatches(qreal xinc, int firstIndex, int lastIndex) const;
+	/// Helper function for paintLines(): draws the lines like paintVisibleLines(), and records them in lineCache_.  If \c painter is 0, the lines are only recorded.
+	void recordLines(QPainter* painter, qreal xinc, int firstIndex, int lastIndex);
+	/// Makes sure that segmentIndex_ is built from the lines for the current data and axis scales.  If lineCache_ is out of date, the lines are recorded first (without drawing them).
+	void updateSegmentIndex();
+	/// Draws lines through the \c count points in \c mappedX and \c mappedY (drawing coordinates), using \c batch.  If \c subSample is true, only the extent of the points within each \c xinc range is drawn, plus a line connecting each range to the next.
+	static void drawMappedLines(QPainter* painter, LineBatch& batch, const qreal* mappedX, const qreal* mappedY, int count, qreal xinc, bool subSample);
+	/// Draws the markers at points \c count-1 down to \c first in \c x and \c y (drawing coordinates): copies of \c sprite if it isn't null, and otherwise \c marker painted as a vector shape.
+	static void drawMarkers(QPainter* painter, const qreal* x, const qreal* y, int first, int count, const QImage& sprite, MPlotAbstractMarker* marker);
+	/// Helper function for paintLines(): when the model has a min/max index (MPlotAbstractSeriesData::setLevelOfDetailEnabled()) and its x-values are sorted, draws the sub-sampled lines between points \c firstIndex and \c lastIndex using O(log n) work per xinc range, without visiting every point.  Returns false (without drawing anything) if this isn't possible.
+	bool paintLinesFromLevelOfDetail(QPainter* painter, qreal xinc, int firstIndex, int lastIndex);
+
+	/// Helper function for paintLines(): queues a line to be drawn, and draws the queue if it's full.
+	void addLine(QPainter* painter, const QPointF& p1, const QPointF& p2) { lineBatch_.addLine(painter, p1, p2); }
+	/// Draws all the lines queued in lineBatch_ with one drawLines() call, and clears them.
+	void flushLines(QPainter* painter) { lineBatch_.flushLines(painter); }
+	/// Draws the points queued in lineBatch_ as one polyline, and clears them.
+	void flushPolyline(QPainter* painter) { lineBatch_.flushPolyline(painter); }
+	/// Helper function for paintMarkers(): returns the pre-rendered marker image to use with \c painter, or a null image if markers must be painted as vector shapes.
+	QImage markerSprite(QPainter* painter) const;
+	/// Helper function for paintMarkers(): drops the markers in \c x and \c y (drawing coordinates, drawn from index \c count-1 down to 0) that \c sprite would draw at the same device pixel as a marker drawn after them (which covers them), and any non-finite points.  The remaining markers are moved to the end of the arrays, keeping their order. Returns the index of the first one.  Nothing is culled for a null sprite, or if the painter is scaled or rotated.
+	int cullHiddenMarkers(QPainter* painter, const QImage& sprite, qreal* x, qreal* y, int count);
+	/// The implementation of cullHiddenMarkers(), for a painter with \c deviceTransform on a device with \c ratio device pixels per logical pixel, and a plot area of \c drawingSize.  \c occupancy is used as scratch space.
+	static int cullHiddenMarkers(const QTransform& deviceTransform, qreal ratio, const QSizeF& drawingSize, const QImage& sprite, QVector<quint32>& occupancy, qreal* x, qreal* y, int count);
+	/// Returns the ratio between device pixels and logical pixels for \c painter's device (always 1 on Qt 4).
+	static qreal devicePixelRatio(QPainter* painter);
+
+	/// Re-used between paints to queue lines for drawLines() and drawPolyline().  Also holds the lineBatchSize().
+	LineBatch lineBatch_;
+	/// During paint(), the part of the item that needs to be re-drawn, expanded by the size of the markers and the lines.  Null if everything must be drawn.
+	QRectF exposedRect_;
+	/// True if markers should be drawn from pre-rendered images when possible.
+	bool markerSpritesEnabled_;
+	/// True if markers landing on an already-occupied device pixel should be skipped.
+	bool markerDeduplicationEnabled_;
+	/// Re-used between paints by cullHiddenMarkers(): one bit per device pixel of the plot area.
+	QVector<quint32> markerOccupancy_;
+
+	/// True if lines should be cached between paints.
+	bool geometryCacheEnabled_;
+	/// The cached lines.
+	LineCache lineCache_;
+	/// Incremented every time lines are recorded in lineCache_.
+	quint64 lineCacheGeneration_;
+	/// The spatial index over the lines in lineCache_, used by hitTest().  Only re-built when it's needed after the lines have changed.
+	MPlotSegmentIndex segmentIndex_;
+	/// The lineCacheGeneration_ that segmentIndex_ was built from.
+	quint64 segmentIndexGeneration_;
+
+	/// True if the series should be drawn by background renders.
+	bool asyncRenderingEnabled_;
+	/// Incremented every time the data or the axis scales change.
+	quint64 asyncDataVersion_;
+	/// Watches the running background render, if any.  Created the first time background rendering is enabled.
+	QFutureWatcher<QImage>* asyncRenderWatcher_;
+	/// True from the start of a background render until onRenderFinished() handles its result.
+	bool asyncRenderRunning_;
+	/// The state that the running background render is drawing.
+	AsyncRenderState asyncRunningState_;
+	/// True if a background render has finished since background rendering was enabled.
+	bool asyncImageReady_;
+	/// The last finished image, and the state that it shows.
+	QImage asyncImage_;
+	AsyncRenderState asyncImageState_;
 
 	/// Customize this if needed for MPlotSeries. For now we use the parent class implementation
 	/*
@@ -2,6 +2,8 @@
 #define __MPlotSeriesData_CPP__
 
 #include "MPlot/MPlotSeriesData.h"
+#include "MPlot/MPlotMinMaxPyramid.h"
+#include "MPlot/MPlotSimd.h"
 
 MPlotSeriesDataSignalSource::MPlotSeriesDataSignalSource(MPlotAbstractSeriesData* parent)
 	: QObject(0) {
@@ -12,10 +14,19 @@ MPlotAbstractSeriesData::MPlotAbstractSeriesData()
 {
 	signalSource_ = new MPlotSeriesDataSignalSource(this);
 	cachedDataRectUpdateRequired_ = true;
+	levelOfDetail_ = 0;
+	xOrderKnown_ = false;
+	xMonotonic_ = true;
+	xOrderCheckedCount_ = 0;
+	rangeChangePrepared_ = false;
+	rangeChangeWasSorted_ = false;
+	rangeChangeOldCount_ = 0;
 }
 
 MPlotAbstractSeriesData::~MPlotAbstractSeriesData()
 {
+	delete levelOfDetail_;
+	levelOfDetail_ = 0;
 	delete signalSource_;
 	signalSource_ = 0;
 }
@@ -28,10 +39,17 @@ QRectF MPlotAbstractSeriesData::boundingRect() const {
 
 	if(cachedDataRectUpdateRequired_) {
 
-		qreal minY = searchMinY();
-		qreal maxY = searchMaxY();
-		qreal minX = searchMinX();
-		qreal maxX = searchMaxX();
+		qreal minX = std::numeric_limits<qreal>::infinity();
+		qreal maxX = -minX;
+		qreal minY = minX;
+		qreal maxY = -minX;
+		searchBounds(0, count()-1, minX, maxX, minY, maxY);
+
+		// If all the values are NaN, so are the bounds.
+		if(!(minX <= maxX))
+			minX = maxX = std::numeric_limits<qreal>::quiet_NaN();
+		if(!(minY <= maxY))
+			minY = maxY = std::numeric_limits<qreal>::quiet_NaN();
 
 		cachedDataRect_ = QRectF(minX,
 								 minY,
@@ -43,71 +61,273 @@ QRectF MPlotAbstractSeriesData::boundingRect() const {
 	return cachedDataRect_;
 }
 
-qreal MPlotAbstractSeriesData::searchMinY() const {
+void MPlotAbstractSeriesData::setLevelOfDetailEnabled(bool enabled)
+{
+	if(enabled == levelOfDetailEnabled())
+		return;
 
-	int size = count();
-	QVector<qreal> y = QVector<qreal>(size);
-	yValues(0, unsigned(size)-1, y.data());
+	if(enabled)
+		levelOfDetail_ = new MPlotMinMaxPyramid(this);
+	else {
+		delete levelOfDetail_;
+		levelOfDetail_ = 0;
+	}
+}
 
-	qreal extreme = y.at(0);
+const MPlotMinMaxPyramid * MPlotAbstractSeriesData::levelOfDetail() const
+{
+	if(levelOfDetail_)
+		levelOfDetail_->update();
 
-	for (int i = 1; i < size; i++)
-		if (y.at(i) < extreme)
-			extreme = y.at(i);
+	return levelOfDetail_;
+}
 
-	return extreme;
+bool MPlotAbstractSeriesData::isXMonotonic() const
+{
+	int total = count();
+
+	if(!xOrderKnown_ || xOrderCheckedCount_ > total) {
+		xOrderKnown_ = true;
+		xMonotonic_ = true;
+		xOrderCheckedCount_ = 0;
+	}
+
+	// Check only the points we haven't seen yet, in chunks, against the last point we have.
+	if(xMonotonic_ && xOrderCheckedCount_ < total) {
+
+		qreal previous = xOrderCheckedCount_ > 0 ? x(unsigned(xOrderCheckedCount_-1)) : -std::numeric_limits<qreal>::infinity();
+		QVector<qreal> chunk = QVector<qreal>(qMin(total-xOrderCheckedCount_, 4096));
+
+		while(xMonotonic_ && xOrderCheckedCount_ < total) {
+			int n = qMin(total-xOrderCheckedCount_, chunk.size());
+			xValues(unsigned(xOrderCheckedCount_), unsigned(xOrderCheckedCount_+n-1), chunk.data());
+
+			for(int i = 0; i < n; ++i) {
+				qreal xi = chunk.at(i);
+				if(!(xi >= previous)) {	// also catches NaN
+					xMonotonic_ = false;
+					break;
+				}
+				previous = xi;
+			}
+			xOrderCheckedCount_ += n;
+		}
+	}
+
+	return xMonotonic_;
 }
 
-qreal MPlotAbstractSeriesData::searchMaxY() const {
+bool MPlotAbstractSeriesData::indexRangeForX(qreal xMin, qreal xMax, int &firstIndex, int &lastIndex) const
+{
+	if(!isXMonotonic())
+		return false;
 
-	int size = count();
-	QVector<qreal> y = QVector<qreal>(size);
-	yValues(0, unsigned(size)-1, y.data());
+	int total = count();
+
+	// First point with x >= xMin:
+	int lo = 0;
+	int hi = total;
+	while(lo < hi) {
+		int mid = lo + (hi-lo)/2;
+		if(x(unsigned(mid)) < xMin)
+			lo = mid+1;
+		else
+			hi = mid;
+	}
+	firstIndex = lo;
+
+	// First point with x > xMax, minus one:
+	hi = total;
+	while(lo < hi) {
+		int mid = lo + (hi-lo)/2;
+		if(x(unsigned(mid)) <= xMax)
+			lo = mid+1;
+		else
+			hi = mid;
+	}
+	lastIndex = lo-1;
 
-	qreal extreme = y.at(0);
+	return true;
+}
 
-	for (int i = 1; i < size; i++)
-		if (y.at(i) > extreme)
-			extreme = y.at(i);
+void MPlotAbstractSeriesData::emitDataChanged()
+{
+	cachedDataRectUpdateRequired_ = true;
+	xOrderKnown_ = false;
+	if(levelOfDetail_)
+		levelOfDetail_->invalidate();
+
+	signalSource_->emitDataChanged();
+}
+
+void MPlotAbstractSeriesData::emitDataShifted(int removedFront, int appended)
+{
+	// Appended points are picked up by the min/max index the next time it's used.
+	if(levelOfDetail_)
+		levelOfDetail_->removeFront(removedFront);
+
+	// Dropping points from the front keeps sorted data sorted, but unsorted data might become sorted.  Appended points are checked the next time isXMonotonic() is called.
+	if(removedFront > 0) {
+		if(xMonotonic_)
+			xOrderCheckedCount_ = qMax(0, xOrderCheckedCount_-removedFront);
+		else
+			xOrderKnown_ = false;
+	}
+
+	int n = appended;
+	int total = count();
+
+	// Removing points could remove the extremes, so the cached bounds are only good if we just appended.
+	if(!cachedDataRectUpdateRequired_ && removedFront == 0 && n > 0 && n < total)
+		extendCachedBounds(total-n, total-1);
+	else
+		cachedDataRectUpdateRequired_ = true;
 
-	return extreme;
+	if(removedFront > 0)
+		signalSource_->emitPointsRemovedFront(removedFront);
+	if(appended > 0)
+		signalSource_->emitPointsAppended(appended);
+	signalSource_->emitDataChanged();
 }
 
-qreal MPlotAbstractSeriesData::searchMinX() const {
+void MPlotAbstractSeriesData::aboutToChangeData(int first, int last)
+{
+	rangeChangePrepared_ = true;
+	rangeChangeWasSorted_ = isXMonotonic();
+	rangeChangeOldCount_ = 0;
+
+	if(cachedDataRectUpdateRequired_ || first < 0 || first > last || last >= count())
+		return;
+
+	// Keep the old values, so that emitDataChanged(int, int) can tell whether a point that was on the edge of the bounds moved inward.  The scratch buffer is re-used, so single-point edits don't allocate.
+	int n = last-first+1;
+	rangeChangeBuffer_.resize(2*n);
+	xValues(unsigned(first), unsigned(last), rangeChangeBuffer_.data());
+	yValues(unsigned(first), unsigned(last), rangeChangeBuffer_.data()+n);
+	rangeChangeOldCount_ = n;
+}
+
+void MPlotAbstractSeriesData::emitDataChanged(int first, int last)
+{
+	bool prepared = rangeChangePrepared_;
+	rangeChangePrepared_ = false;
+
+	// If the x-values weren't sorted before, views can't tell where the changed points used to be drawn.
+	if(!prepared || !rangeChangeWasSorted_ || first < 0 || first > last || last >= count()) {
+		emitDataChanged();
+		return;
+	}
 
-	int size = count();
-	QVector<qreal> x = QVector<qreal>(size);
-	xValues(0, unsigned(size)-1, x.data());
+	int n = last-first+1;
+	if(!cachedDataRectUpdateRequired_ && rangeChangeOldCount_ == n) {
+		// The scratch buffer holds the old x- and y-values; the new ones go after them.
+		rangeChangeBuffer_.resize(4*n);
+		qreal* oldX = rangeChangeBuffer_.data();
+		qreal* oldY = oldX + n;
+		qreal* newX = oldX + 2*n;
+		qreal* newY = oldX + 3*n;
+		xValues(unsigned(first), unsigned(last), newX);
+		yValues(unsigned(first), unsigned(last), newY);
+
+		qreal minX = cachedDataRect_.left();
+		qreal maxX = cachedDataRect_.right();
+		qreal minY = cachedDataRect_.top();
+		qreal maxY = cachedDataRect_.bottom();
+
+		// The bounds can only shrink if a point that was on an edge moved inward.  Points that stayed put (ex: the first or last point of sorted data, when only its y-value changed) or moved outward are fine.  (A NaN new value fails the comparisons, which is the safe answer.)
+		bool boundsKept = true;
+		for(int i=0; i<n && boundsKept; ++i) {
+			if((!(oldX[i] > minX) && !(newX[i] <= oldX[i]))
+					|| (!(oldX[i] < maxX) && !(newX[i] >= oldX[i]))
+					|| (!(oldY[i] > minY) && !(newY[i] <= oldY[i]))
+					|| (!(oldY[i] < maxY) && !(newY[i] >= oldY[i])))
+				boundsKept = false;
+		}
 
-	qreal extreme = x.at(0);
+		if(boundsKept) {
+			MPlotSimd::minMax(n, newX, minX, maxX);
+			MPlotSimd::minMax(n, newY, minY, maxY);
+			cachedDataRect_ = QRectF(minX,
+									 minY,
+									 qMax(maxX-minX, std::numeric_limits<qreal>::min()),
+									 qMax(maxY-minY, std::numeric_limits<qreal>::min()));
+		}
+		else
+			cachedDataRectUpdateRequired_ = true;
+	}
+	else
+		cachedDataRectUpdateRequired_ = true;
+	rangeChangeOldCount_ = 0;
+
+	// The x-values were sorted; they still are if the changed points are in order with their neighbours.
+	int lo = qMax(0, first-1);
+	int hi = qMin(count()-1, last+1);
+	rangeChangeBuffer_.resize(hi-lo+1);
+	const qreal* x = rangeChangeBuffer_.data();
+	xValues(unsigned(lo), unsigned(hi), rangeChangeBuffer_.data());
+	for(int i=0, size=hi-lo+1; i<size; ++i) {
+		if(!(x[i] == x[i]) || (i > 0 && !(x[i] >= x[i-1]))) {
+			xMonotonic_ = false;
+			break;
+		}
+	}
 
-	for (int i = 1; i < size; i++)
-		if (x.at(i) < extreme)
-			extreme = x.at(i);
+	if(levelOfDetail_)
+		levelOfDetail_->updateRange(first, last);
 
-	return extreme;
+	if(xMonotonic_)
+		signalSource_->emitDataRangeChanged(first, last);
+	signalSource_->emitDataChanged();
 }
 
-qreal MPlotAbstractSeriesData::searchMaxX() const {
+void MPlotAbstractSeriesData::extendCachedBounds(int first, int last)
+{
+	qreal minX = cachedDataRect_.left();
+	qreal maxX = cachedDataRect_.right();
+	qreal minY = cachedDataRect_.top();
+	qreal maxY = cachedDataRect_.bottom();
 
-	int size = count();
-	QVector<qreal> x = QVector<qreal>(size);
-	xValues(0, unsigned(size)-1, x.data());
+	searchBounds(first, last, minX, maxX, minY, maxY);
 
-	qreal extreme = x.at(0);
+	cachedDataRect_ = QRectF(minX,
+							 minY,
+							 qMax(maxX-minX, std::numeric_limits<qreal>::min()),
+							 qMax(maxY-minY, std::numeric_limits<qreal>::min()));
+}
 
-	for (int i = 1; i < size; i++)
-		if (x.at(i) > extreme)
-			extreme = x.at(i);
+void MPlotAbstractSeriesData::searchBounds(int first, int last, qreal &minX, qreal &maxX, qreal &minY, qreal &maxY) const
+{
+	QVector<qreal> buffer;
 
-	return extreme;
+	for(int start = first; start <= last; start += MPLOT_BOUNDS_CHUNK_SIZE) {
+		int end = qMin(last, start + MPLOT_BOUNDS_CHUNK_SIZE - 1);
+		int n = end-start+1;
+
+		MPlotDataSpan span = xSpan(unsigned(start), unsigned(end));
+		if(span.isNull() || span.stride() != 1) {
+			buffer.resize(n);
+			xValues(unsigned(start), unsigned(end), buffer.data());
+			span = MPlotDataSpan(buffer.constData());
+		}
+		MPlotSimd::minMax(n, span.data(), minX, maxX);
+
+		span = ySpan(unsigned(start), unsigned(end));
+		if(span.isNull() || span.stride() != 1) {
+			buffer.resize(n);
+			yValues(unsigned(start), unsigned(end), buffer.data());
+			span = MPlotDataSpan(buffer.constData());
+		}
+		MPlotSimd::minMax(n, span.data(), minY, maxY);
+	}
 }
 
 MPlotRealtimeModel::MPlotRealtimeModel(QObject *parent) :
-		QAbstractTableModel(parent), MPlotAbstractSeriesData(), xName_("x"), yName_("y")
+		QAbstractTableModel(parent), MPlotAbstractSeriesData(), minX_(false), maxX_(true), minY_(false), maxY_(true), xName_("x"), yName_("y")
 {
-	// min/max tracking indices are invalid at start (empty model)
-	minYIndex_ = maxYIndex_ = minXIndex_ = maxXIndex_ = -1;
+	fixedCapacity_ = 0;
+	frontPosition_ = 0;
+	extremaRescanRequired_ = false;
+	extremaPopEnd_ = MPlotSlidingExtremum::PopFront;
 
 	// Axis names: initialized on first line to "x", "y" (Real original... I know.)
 }
@@ -192,18 +412,27 @@ bool MPlotRealtimeModel::setData(const QModelIndex &index, const QVariant &value
 		if(!conversionOK)
 			return false;
 
+		int row = index.row();
+		qint64 position = frontPosition_ + row;
+
 		// Setting an x value?
 		if(index.column() == 0) {
-			minMaxChangeCheckX(dval, index.row());
+			aboutToChangeData(row, row);
+			xval_[row] = dval;
+			if(!extremaRescanRequired_ && !(minX_.replace(position, dval) && maxX_.replace(position, dval)))
+				extremaRescanRequired_ = true;
 			emit QAbstractItemModel::dataChanged(index, index);
-			emitDataChanged();
+			emitDataChanged(row, row);
 			return true;
 		}
 		// Setting a y value?
 		if(index.column() == 1) {
-			minMaxChangeCheckY(dval, index.row());
+			aboutToChangeData(row, row);
+			yval_[row] = dval;
+			if(!extremaRescanRequired_ && !(minY_.replace(position, dval) && maxY_.replace(position, dval)))
+				extremaRescanRequired_ = true;
 			emit QAbstractItemModel::dataChanged(index, index);
-			emitDataChanged();
+			emitDataChanged(row, row);
 			return true;
 		}
 	}
@@ -221,19 +450,20 @@ Qt::ItemFlags MPlotRealtimeModel::flags(const QModelIndex &index) const {
 
 // This allows you to add data points at the beginning:
 void MPlotRealtimeModel::insertPointFront(qreal x, qreal y) {
+	// Full? Make room by dropping the newest point at the back.
+	if(fixedCapacity_ > 0 && xval_.count() >= fixedCapacity_) {
+		beginRemoveRows(QModelIndex(), xval_.count()-1, xval_.count()-1);
+		dropBack(1);
+		endRemoveRows();
+	}
+
 	beginInsertRows(QModelIndex(), 0, 0);
 
 	xval_.prepend(x);
 	yval_.prepend(y);
+	frontPosition_--;
 
-	// Update the max/min index trackers:
-	minXIndex_++;
-	minYIndex_++;
-	maxXIndex_++;
-	maxYIndex_++;
-
-	// Check if this guy is a new min or max:
-	minMaxAddCheck(x, y, 0);
+	extremaPushFront(x, y);
 
 	endInsertRows();
 
@@ -243,49 +473,92 @@ void MPlotRealtimeModel::insertPointFront(qreal x, qreal y) {
 
 // This allows you to add data points at the end:
 void MPlotRealtimeModel::insertPointBack(qreal x, qreal y) {
+	// Full? Make room by evicting the oldest point at the front.
+	int evicted = 0;
+	if(fixedCapacity_ > 0 && xval_.count() >= fixedCapacity_) {
+		beginRemoveRows(QModelIndex(), 0, 0);
+		dropFront(1);
+		endRemoveRows();
+		evicted = 1;
+	}
+
 	beginInsertRows(QModelIndex(), xval_.count(), xval_.count());
 
 	xval_.append(x);
 	yval_.append(y);
 
-	minMaxAddCheck(x, y, xval_.count()-1);
+	extremaPushBack(x, y);
 
 	endInsertRows();
 	// Signal a full-plot update
-	emitDataChanged();
+	emitDataShifted(evicted, 1);
 }
 
-// Remove a point at the front (Returns true if successful).
-bool MPlotRealtimeModel::removePointFront() {
-	if(xval_.isEmpty())
-		return false;
+void MPlotRealtimeModel::insertPointsBack(const qreal *x, const qreal *y, int n)
+{
+	if(n <= 0)
+		return;
 
-	beginRemoveRows(QModelIndex(), 0, 0);
+	// In fixed-capacity mode, only the last fixedCapacity_ points of the block can survive.
+	if(fixedCapacity_ > 0 && n > fixedCapacity_) {
+		x += n - fixedCapacity_;
+		y += n - fixedCapacity_;
+		n = fixedCapacity_;
+	}
+
+	// Make room by evicting the oldest points at the front.
+	int evicted = 0;
+	if(fixedCapacity_ > 0) {
+		int excess = xval_.count() + n - fixedCapacity_;
+		if(excess > 0) {
+			beginRemoveRows(QModelIndex(), 0, excess-1);
+			dropFront(excess);
+			endRemoveRows();
+			evicted = excess;
+		}
+	}
+
+	beginInsertRows(QModelIndex(), xval_.count(), xval_.count()+n-1);
+
+	xval_.reserve(xval_.count()+n);
+	yval_.reserve(yval_.count()+n);
+	for(int i=0; i<n; ++i) {
+		xval_.append(x[i]);
+		yval_.append(y[i]);
+		extremaPushBack(x[i], y[i]);
+	}
+
+	endInsertRows();
 
-	xval_.takeFirst();
-	yval_.takeFirst();
+	// Signal a full-plot update, once for the whole block
+	emitDataShifted(evicted, n);
+}
 
-	// Update the max/min index trackers:
-	minXIndex_--;
-	minYIndex_--;
-	maxXIndex_--;
-	maxYIndex_--;
+int MPlotRealtimeModel::removePointsFront(int n)
+{
+	n = qMin(n, xval_.count());
+	if(n <= 0)
+		return 0;
+
+	beginRemoveRows(QModelIndex(), 0, n-1);
+	dropFront(n);
+	endRemoveRows();
 
-	// Did we remove the current max/min?
-	if(minYIndex_ == -1)
-		minYIndex_ = searchMinIndex(yval_);
-	if(maxYIndex_ == -1)
-		maxYIndex_ = searchMaxIndex(yval_);
-	if(minXIndex_ == -1)
-		minXIndex_ = searchMinIndex(xval_);
-	if(maxXIndex_ == -1)
-		maxXIndex_ = searchMaxIndex(xval_);
+	emitDataRemovedFront(n);
+	return n;
+}
 
+// Remove a point at the front (Returns true if successful).
+bool MPlotRealtimeModel::removePointFront() {
+	if(xval_.isEmpty())
+		return false;
 
+	beginRemoveRows(QModelIndex(), 0, 0);
+	dropFront(1);
 	endRemoveRows();
 
 	// Signal a full-plot update
-	emitDataChanged();
+	emitDataRemovedFront(1);
 	return true;
 }
 
@@ -295,21 +568,7 @@ bool MPlotRealtimeModel::removePointBack() {
 		return false;
 
 	beginRemoveRows(QModelIndex(), xval_.count()-1, xval_.count()-1);
-
-	xval_.takeLast();
-	yval_.takeLast();
-
-	// Did we remove the current max/min?
-	int oldIndexToCheck = xval_.count();
-	if(minYIndex_ == oldIndexToCheck)
-		minYIndex_ = searchMinIndex(yval_);
-	if(maxYIndex_ == oldIndexToCheck)
-		maxYIndex_ = searchMaxIndex(yval_);
-	if(minXIndex_ == oldIndexToCheck)
-		minXIndex_ = searchMinIndex(xval_);
-	if(maxXIndex_ == oldIndexToCheck)
-		maxXIndex_ = searchMaxIndex(xval_);
-
+	dropBack(1);
 	endRemoveRows();
 
 	// Signal a full-plot update
@@ -317,10 +576,32 @@ bool MPlotRealtimeModel::removePointBack() {
 	return true;
 }
 
+void MPlotRealtimeModel::setFixedCapacity(int capacity)
+{
+	fixedCapacity_ = qMax(0, capacity);
+	if(fixedCapacity_ == 0)
+		return;
+
+	xval_.reserve(fixedCapacity_);
+	yval_.reserve(fixedCapacity_);
+
+	int excess = xval_.count() - fixedCapacity_;
+	if(excess > 0) {
+		beginRemoveRows(QModelIndex(), 0, excess-1);
+		dropFront(excess);
+		endRemoveRows();
+
+		emitDataRemovedFront(excess);
+	}
+}
+
 QRectF MPlotRealtimeModel::boundingRect() const {
 	if(xval_.isEmpty() || yval_.isEmpty())
 		return QRectF();	// No data... return an invalid QRectF
 
+	if(extremaRescanRequired_)
+		rescanExtrema();
+
 	return QRectF(minX(), minY(), maxX()-minX(), maxY()-minY());
 
 }
@@ -328,117 +609,111 @@ QRectF MPlotRealtimeModel::boundingRect() const {
 
 
 // Helper functions:
-// Check if an added point @ index is the new min. or max record holder:
-// Must call this AFTER adding both x and y to the xval_ and y_val lists.
-void MPlotRealtimeModel::minMaxAddCheck(qreal x, qreal y, int index) {
-
-	// in case of previously-empty list (min_Index_ initialized to -1)
-	if(xval_.count() == 1) {
-		minYIndex_ = index;
-		maxYIndex_ = index;
-		minXIndex_ = index;
-		maxXIndex_ = index;
+void MPlotRealtimeModel::extremaPushBack(qreal x, qreal y)
+{
+	// Trackers are going to be re-filled anyway.
+	if(extremaRescanRequired_)
 		return;
-	}
-
-	// New x max found:
-	if(x > xval_.at(maxXIndex_))
-		maxXIndex_ = index;
-	// New x min found:
-	if(x < xval_.at(minXIndex_))
-		minXIndex_ = index;
-	// New y max found:
-	if(y > yval_.at(maxYIndex_))
-		maxYIndex_ = index;
-	if(y < yval_.at(minYIndex_))
-		minYIndex_ = index;
 
+	qint64 position = frontPosition_ + xval_.count() - 1;
+	minX_.pushBack(position, x);
+	maxX_.pushBack(position, x);
+	minY_.pushBack(position, y);
+	maxY_.pushBack(position, y);
 }
 
-// Check if a point modified at index causes us to lose our record holders, or is a new record holder.
-// Inserts the point (modifies the data array).
-void MPlotRealtimeModel::minMaxChangeCheckX(qreal newVal, int index) {
-
-	qreal oldVal = xval_.at(index);
-	xval_[index] = newVal;
-
-	// Maybe not the max anymore... Need to find the new one:
-	if(index == maxXIndex_ && newVal < oldVal)
-		maxXIndex_ = searchMaxIndex(xval_);
-
-	// Maybe not the min anymore... Need to find the new one:
-	if(index == minXIndex_ && newVal > oldVal)
-		minXIndex_ = searchMinIndex(xval_);
-
-	if(newVal > xval_.at(maxXIndex_))
-		maxXIndex_ = index;
-
-	if(newVal < xval_.at(minXIndex_))
-		minXIndex_ = index;
-
+void MPlotRealtimeModel::extremaPushFront(qreal x, qreal y)
+{
+	if(extremaRescanRequired_)
+		return;
 
+	minX_.pushFront(frontPosition_, x);
+	maxX_.pushFront(frontPosition_, x);
+	minY_.pushFront(frontPosition_, y);
+	maxY_.pushFront(frontPosition_, y);
 }
-void MPlotRealtimeModel::minMaxChangeCheckY(qreal newVal, int index) {
-
-	qreal oldVal = yval_.at(index);
-	yval_[index] = newVal;
 
-	// Maybe not the max anymore... Need to find the new one:
-	if(index == maxYIndex_ && newVal < oldVal)
-		maxYIndex_ = searchMaxIndex(yval_);
-
-	// Maybe not the min anymore... Need to find the new one:
-	if(index == minYIndex_ && newVal > oldVal)
-		minYIndex_ = searchMinIndex(yval_);
-
-	if(newVal > yval_.at(maxYIndex_))
-		maxYIndex_ = index;
-
-	if(newVal < yval_.at(minYIndex_))
-		minYIndex_ = index;
+void MPlotRealtimeModel::dropFront(int n)
+{
+	// Trackers set up for a window sliding backward can't drop points from the front: switch them around at the next re-scan.
+	if(minX_.popEnd() != MPlotSlidingExtremum::PopFront)
+		extremaRescanRequired_ = true;
 
+	if(extremaRescanRequired_)
+		extremaPopEnd_ = MPlotSlidingExtremum::PopFront;
+	else {
+		for(int i=0; i<n; ++i) {
+			qint64 position = frontPosition_ + i;
+			minX_.popFront(position);
+			maxX_.popFront(position);
+			minY_.popFront(position);
+			maxY_.popFront(position);
+		}
+	}
 
+	xval_.removeFirst(n);
+	yval_.removeFirst(n);
+	frontPosition_ += n;
 }
 
-int MPlotRealtimeModel::searchMaxIndex(const QList<qreal>& list) {
-	if(list.isEmpty())
-		return -1;
+void MPlotRealtimeModel::dropBack(int n)
+{
+	// Trackers set up for a window sliding forward can't drop points from the back.  Re-fill them for a window sliding backward later, when the bounds are next needed; after that, dropping more points from the back is O(1) again.
+	if(minX_.popEnd() != MPlotSlidingExtremum::PopBack)
+		extremaRescanRequired_ = true;
 
-	int mi = 0;	// max index
-	for(int i=1; i<list.count(); i++)
-		if(list.at(i) > list.at(mi))
-			mi = i;
+	if(extremaRescanRequired_)
+		extremaPopEnd_ = MPlotSlidingExtremum::PopBack;
+	else {
+		qint64 backPosition = frontPosition_ + xval_.count() - 1;
+		for(int i=0; i<n; ++i) {
+			qint64 position = backPosition - i;
+			minX_.popBack(position);
+			maxX_.popBack(position);
+			minY_.popBack(position);
+			maxY_.popBack(position);
+		}
+	}
 
-	return mi;
+	xval_.removeLast(n);
+	yval_.removeLast(n);
 }
 
-int MPlotRealtimeModel::searchMinIndex(const QList<qreal>& list) {
-	if(list.isEmpty())
-		return -1;
-
-	int mi = 0;	// min index
-	for(int i=1; i<list.count(); i++)
-		if(list.at(i) < list.at(mi))
-			mi = i;
+void MPlotRealtimeModel::rescanExtrema() const
+{
+	minX_.clear(extremaPopEnd_);
+	maxX_.clear(extremaPopEnd_);
+	minY_.clear(extremaPopEnd_);
+	maxY_.clear(extremaPopEnd_);
+
+	for(int i=0, cc=xval_.count(); i<cc; ++i) {
+		qint64 position = frontPosition_ + i;
+		qreal x = xval_.at(i);
+		qreal y = yval_.at(i);
+		minX_.pushBack(position, x);
+		maxX_.pushBack(position, x);
+		minY_.pushBack(position, y);
+		maxY_.pushBack(position, y);
+	}
 
-	return mi;
+	extremaRescanRequired_ = false;
 }
 
 // Warning: only call these if the list is not empty:
 qreal MPlotRealtimeModel::minY() const {
-	return yval_.at(minYIndex_);
+	return minY_.isEmpty() ? 0.0 : minY_.value();
 }
 
 qreal MPlotRealtimeModel::maxY() const {
-	return yval_.at(maxYIndex_);
+	return maxY_.isEmpty() ? 0.0 : maxY_.value();
 }
 
 qreal MPlotRealtimeModel::minX() const {
-	return xval_.at(minXIndex_);
+	return minX_.isEmpty() ? 0.0 : minX_.value();
 }
 
 qreal MPlotRealtimeModel::maxX() const {
-	return xval_.at(maxXIndex_);
+	return maxX_.isEmpty() ? 0.0 : maxX_.value();
 }
 
 bool MPlotVectorSeriesData::setValues(const QVector<qreal> &xValues, const QVector<qreal> &yValues)
@@ -457,8 +732,9 @@ bool MPlotVectorSeriesData::setXValue(int index, qreal xValue)
 	if((unsigned)index >= (unsigned)xValues_.count())
 		return false;
 
+	aboutToChangeData(index, index);
 	xValues_[index] = xValue;
-	emitDataChanged();
+	emitDataChanged(index, index);
 	return true;
 }
 
@@ -467,11 +743,38 @@ bool MPlotVectorSeriesData::setYValue(int index, qreal yValue)
 	if((unsigned)index >= (unsigned)yValues_.count())
 		return false;
 
+	aboutToChangeData(index, index);
 	yValues_[index] = yValue;
-	emitDataChanged();
+	emitDataChanged(index, index);
 	return true;
 }
 
+void MPlotVectorSeriesData::insertPointsBack(const qreal *x, const qreal *y, int n)
+{
+	if(n <= 0)
+		return;
+
+	int oldCount = xValues_.count();
+	xValues_.resize(oldCount+n);
+	yValues_.resize(oldCount+n);
+	memcpy(xValues_.data()+oldCount, x, n*sizeof(qreal));
+	memcpy(yValues_.data()+oldCount, y, n*sizeof(qreal));
+
+	emitDataAppended(n);
+}
+
+int MPlotVectorSeriesData::removePointsFront(int n)
+{
+	n = qMin(n, xValues_.count());
+	if(n <= 0)
+		return 0;
+
+	xValues_.remove(0, n);
+	yValues_.remove(0, n);
+	emitDataRemovedFront(n);
+	return n;
+}
+
 MPlotVectorSeriesData::MPlotVectorSeriesData()
 	: MPlotAbstractSeriesData()
 {
@@ -479,16 +782,87 @@ MPlotVectorSeriesData::MPlotVectorSeriesData()
 
 void MPlotRealtimeModel::xValues(unsigned indexStart, unsigned indexEnd, qreal *outputValues) const
 {
-	for(unsigned i=indexStart; i<=indexEnd; ++i)
-		*(outputValues++) = xval_.at(i);
+	xval_.copyValues(indexStart, indexEnd-indexStart+1, outputValues);
 }
 
 void MPlotRealtimeModel::yValues(unsigned indexStart, unsigned indexEnd, qreal *outputValues) const
 {
-	for(unsigned i=indexStart; i<=indexEnd; ++i)
-		*(outputValues++) = yval_.at(i);
+	yval_.copyValues(indexStart, indexEnd-indexStart+1, outputValues);
 }
 
 
+MPlotQueuedRealtimeModel::MPlotQueuedRealtimeModel(int queueCapacity, QObject *parent)
+	: MPlotRealtimeModel(parent), queue_(queueCapacity), drainTimer_(this), droppedPoints_(0)
+{
+	connect(&drainTimer_, SIGNAL(timeout()), this, SLOT(drain()));
+	drainTimer_.start(MPLOT_DEFAULT_DRAIN_INTERVAL);
+}
+
+int MPlotQueuedRealtimeModel::pushPoints(const qreal *x, const qreal *y, int n)
+{
+	// Pack the points in small blocks on the stack, so pushing never allocates.
+	QPointF block[256];
+	int pushed = 0;
+
+	while(pushed < n) {
+		int blockSize = qMin(n-pushed, 256);
+		for(int i = 0; i < blockSize; ++i)
+			block[i] = QPointF(x[pushed+i], y[pushed+i]);
+
+		int accepted = queue_.push(block, blockSize);
+		pushed += accepted;
+		if(accepted < blockSize)
+			break;
+	}
+
+	// The count saturates at INT_MAX instead of wrapping negative when a producer keeps overrunning the queue.
+	if(pushed < n) {
+		int dropped = n-pushed;
+		int previous;
+		do {
+			previous = droppedPoints_.fetchAndAddRelaxed(0);
+			if(previous == std::numeric_limits<int>::max())
+				break;
+		} while(!droppedPoints_.testAndSetRelaxed(previous, previous + qMin(dropped, std::numeric_limits<int>::max()-previous)));
+	}
+
+	return pushed;
+}
+
+int MPlotQueuedRealtimeModel::droppedPointCount() const
+{
+	return const_cast<QAtomicInt&>(droppedPoints_).fetchAndAddRelaxed(0);
+}
+
+void MPlotQueuedRealtimeModel::setDrainInterval(int milliseconds)
+{
+	if(milliseconds > 0)
+		drainTimer_.start(milliseconds);
+	else
+		drainTimer_.stop();
+}
+
+int MPlotQueuedRealtimeModel::drain()
+{
+	if(drainBuffer_.size() < queue_.capacity())
+		drainBuffer_.resize(queue_.capacity());
+
+	int n = queue_.pop(drainBuffer_.data(), drainBuffer_.size());
+	if(n == 0)
+		return 0;
+
+	if(drainX_.size() < n) {
+		drainX_.resize(n);
+		drainY_.resize(n);
+	}
+	for(int i = 0; i < n; ++i) {
+		drainX_[i] = drainBuffer_.at(i).x();
+		drainY_[i] = drainBuffer_.at(i).y();
+	}
+
+	insertPointsBack(drainX_.constData(), drainY_.constData(), n);
+	return n;
+}
+
 #endif
 
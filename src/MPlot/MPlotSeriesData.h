@@ -2,16 +2,47 @@
 #define __MPlotSeriesData_H__
 
 #include "MPlot/MPlot_global.h"
+#include "MPlot/MPlotRingBuffer.h"
+#include "MPlot/MPlotSpscQueue.h"
 
 #include <QAbstractTableModel>
 #include <QQueue>
 #include <QList>
+#include <QPointF>
 #include <QRectF>
+#include <QTimer>
 #include <QVector>
 
 #include <limits>
 
 class MPlotAbstractSeriesData;
+class MPlotMinMaxPyramid;
+
+/// The number of points that MPlotAbstractSeriesData::searchBounds() reads from a model at once.  Small enough for the x- and y-values to stay in the L1 cache.
+#define MPLOT_BOUNDS_CHUNK_SIZE 2048
+
+/// A read-only view of values stored directly in a data model's memory: value \c i is at data()[i*stride()].
+/*! Returned by MPlotAbstractSeriesData::xSpan() and ySpan(). A null span (data() == 0) means the model can't provide direct access for the requested range, and the values must be copied out with xValues() or yValues() instead.  The pointer is only valid until the model's data changes. */
+class MPLOTSHARED_EXPORT MPlotDataSpan {
+public:
+	/// Constructs a null span.
+	MPlotDataSpan() : data_(0), stride_(1) {}
+	/// Constructs a span starting at \c data, with \c stride qreals between consecutive values.
+	MPlotDataSpan(const qreal* data, int stride = 1) : data_(data), stride_(stride) {}
+
+	/// Returns true if the model couldn't provide direct access.
+	bool isNull() const { return data_ == 0; }
+	/// Returns a pointer to the first value.
+	const qreal* data() const { return data_; }
+	/// Returns the distance between consecutive values, in qreals.  1 for contiguous arrays.
+	int stride() const { return stride_; }
+	/// Returns value \c i of the span.
+	qreal at(int i) const { return data_[i*stride_]; }
+
+protected:
+	const qreal* data_;
+	int stride_;
+};
 
 
 /// This class acts as a proxy to emit signals for MPlotAbstractSeriesData. You can receive the dataChanged() signal by hooking up to MPlotAbstractSeries::signalSource().
@@ -20,6 +51,8 @@ class MPlotAbstractSeriesData;
   Implementations must do two things:
   1) Implement the virtual functions x(), y(), and count()
   2) Call emitDataChanged() whenever the count() or x/y values have changed.
+
+  dataChanged() is emitted for every change.  When the model can say exactly what changed, one or more of the detailed signals (dataRangeChanged(), pointsAppended(), pointsRemovedFront()) are emitted first, so that views can update incrementally and then ignore the dataChanged() that follows.
   */
 class MPLOTSHARED_EXPORT MPlotSeriesDataSignalSource : public QObject {
 	Q_OBJECT
@@ -28,12 +61,22 @@ public:
 protected:
 	MPlotSeriesDataSignalSource(MPlotAbstractSeriesData* parent);
 	void emitDataChanged() { emit dataChanged(); }
+	void emitDataRangeChanged(int first, int last) { emit dataRangeChanged(first, last); }
+	void emitPointsAppended(int n) { emit pointsAppended(n); }
+	void emitPointsRemovedFront(int n) { emit pointsRemovedFront(n); }
 
 	MPlotAbstractSeriesData* data_;
 	friend class MPlotAbstractSeriesData;
 
 signals:
+	/// Emitted whenever the data changes in any way.
 	void dataChanged();
+	/// Emitted (before dataChanged()) when only the values of the points from \c first to \c last (inclusive) have changed, and the x-values are still sorted.
+	void dataRangeChanged(int first, int last);
+	/// Emitted (before dataChanged()) when \c n points were appended at the end.
+	void pointsAppended(int n);
+	/// Emitted (before dataChanged()) when \c n points were removed from the front.
+	void pointsRemovedFront(int n);
 };
 
 /// This defines the interface for classes which may be used for Series (XY scatter) plot data.
@@ -56,36 +99,80 @@ public:
 	/// Copy all the y values from \c indexStart to \c indexEnd (inclusive) into \c outputValues.  You can assume that the indexes are valid.
 	virtual void yValues(unsigned indexStart, unsigned indexEnd, qreal* outputValues) const = 0;
 
+	/// Optionally returns direct (zero-copy) access to the x values from \c indexStart to \c indexEnd (inclusive).  Models that store their values contiguously (or with a regular stride) should re-implement this; the base class returns a null span, which means "use xValues() instead".
+	virtual MPlotDataSpan xSpan(unsigned indexStart, unsigned indexEnd) const { Q_UNUSED(indexStart) Q_UNUSED(indexEnd) return MPlotDataSpan(); }
+	/// Optionally returns direct (zero-copy) access to the y values from \c indexStart to \c indexEnd (inclusive).  The base class returns a null span, which means "use yValues() instead".
+	virtual MPlotDataSpan ySpan(unsigned indexStart, unsigned indexEnd) const { Q_UNUSED(indexStart) Q_UNUSED(indexEnd) return MPlotDataSpan(); }
+
 	/// Return the number of data points.
 	virtual int count() const = 0;
 
 	/// Return the bounds of the data (the rectangle containing the max/min x- and y-values). It should be expressed as: QRectF(left, top, width, height) = QRectF(minX, minY, maxX-minX, maxY-minY);
 	/*! \todo Should we change this so that the QRectF's "top()" is actually maxY instead of minY?
 
-The base class implementation does a linear search through the data for the maximum and minimum values. It caches the result, and invalidates this result whenever the data changes (ie: emitDataChanged() is called). If you have a faster way of determining the bounds of the data, be sure to re-implement this. */
+The base class implementation does a linear search through the data for the maximum and minimum values (see searchBounds()). It caches the result, and invalidates this result whenever the data changes (ie: emitDataChanged() is called).  Points reported with emitDataAppended() only extend the cached result.  If you have a faster way of determining the bounds of the data, be sure to re-implement this. */
 	virtual QRectF boundingRect() const;
 
+	/// Enables or disables a multi-resolution min/max index (MPlotMinMaxPyramid) of this data's y-values.  When enabled, series views like MPlotSeriesBasic can draw very large datasets (with x-values in ascending order) in time proportional to the number of pixel columns, rather than the number of points.
+	/*! The index is built the first time it is needed, and then updated incrementally when implementations report appended points or points removed from the front (see emitDataAppended() and emitDataRemovedFront()). Any other change (emitDataChanged()) requires a full re-build.  It costs about 2*sizeof(qreal)*2/MPLOT_MINMAXPYRAMID_BLOCK_SIZE bytes per point. Disabled by default. */
+	void setLevelOfDetailEnabled(bool enabled = true);
+	/// Returns true if the min/max index is enabled.
+	bool levelOfDetailEnabled() const { return levelOfDetail_ != 0; }
+	/// Returns the min/max index, brought up-to-date with the current data, or 0 if it isn't enabled.
+	const MPlotMinMaxPyramid* levelOfDetail() const;
+
+	/// Returns true if the x-values are in ascending (non-decreasing) order, and none of them are NaN.
+	/*! The result is cached.  Points reported with emitDataAppended() are checked incrementally, and removing points from the front of sorted data keeps it sorted; any other change (emitDataChanged()) requires a full re-scan the next time this is called. */
+	bool isXMonotonic() const;
+	/// Finds the range of points whose x-values are within [\c xMin, \c xMax]: \c firstIndex is set to the first point with x >= \c xMin, and \c lastIndex to the last point with x <= \c xMax.  If no points are inside the range, \c lastIndex will be \c firstIndex - 1.
+	/*! Returns false (and leaves the indexes unchanged) if this can't be done because the x-values aren't sorted (isXMonotonic()).  The base class implementation does a binary search using x(), in O(log n) time.  Re-implement if you have a faster way. */
+	virtual bool indexRangeForX(qreal xMin, qreal xMax, int& firstIndex, int& lastIndex) const;
+
 private:
 	MPlotSeriesDataSignalSource* signalSource_;
 	friend class MPlotSeriesDataSignalSource;
 
 protected:
 	/// Implementing classes should call this when their x- y- data changes in any way (ie: points added, points removed, or even values changed such that the bounds of the plot might be different.)
-	void emitDataChanged() { cachedDataRectUpdateRequired_ = true; signalSource_->emitDataChanged(); }
+	void emitDataChanged();
+	/// Implementing classes can call this (before changing anything) and then emitDataChanged(int, int) (after), instead of emitDataChanged(), when only the values of the points from \c first to \c last (inclusive) are going to change.  This saves the old values, so that the cached bounds can be kept if none of the points on the edge of the bounds move inward.
+	void aboutToChangeData(int first, int last);
+	/// Implementing classes can call this instead of emitDataChanged() when only the values of the points from \c first to \c last (inclusive) have changed, and aboutToChangeData() was called before changing them.  The cached bounds are extended with the new values (unless a point that was on the edge of the bounds moved inward, so the bounds might shrink), and the min/max index is updated for just those points.  dataRangeChanged() is emitted before dataChanged().
+	void emitDataChanged(int first, int last);
+	/// Implementing classes can call this instead of emitDataChanged() when the only change is that \c n points were appended at the end.  If the cached bounds are still valid, they are extended to include the new points (instead of being re-computed with a full search the next time boundingRect() is called), and the min/max index is updated incrementally.
+	void emitDataAppended(int n) { emitDataShifted(0, n); }
+	/// Implementing classes can call this instead of emitDataChanged() when the only change is that \c n points were removed from the front.  The min/max index is updated incrementally.
+	void emitDataRemovedFront(int n) { emitDataShifted(n, 0); }
+	/// Implementing classes can call this instead of emitDataChanged() when \c removedFront points were removed from the front, and then \c appended points were added at the end (ex: a fixed-size buffer that evicts old points as new ones arrive).  Only one dataChanged() signal is emitted.
+	void emitDataShifted(int removedFront, int appended);
 
 protected:
 	/// Implements caching for the search-based version of boundingRect().
 	mutable QRectF cachedDataRect_;
 	/// Implements caching for the search-based version of boundingRect().
 	mutable bool cachedDataRectUpdateRequired_;
-	/// Search for minimum Y value. Call only when count() > 0.
-	qreal searchMinY() const;
-	/// Search for extreme value. Call only when count() > 0.
-	qreal searchMaxY() const;
-	/// Search for extreme value. Call only when count() > 0.
-	qreal searchMinX() const;
-	/// Search for extreme value. Call only when count() > 0.
-	qreal searchMaxX() const;
+	/// The min/max index, if enabled with setLevelOfDetailEnabled(). Otherwise 0.
+	mutable MPlotMinMaxPyramid* levelOfDetail_;
+	/// Implements caching for isXMonotonic(): false if the x-order must be re-scanned from the start.
+	mutable bool xOrderKnown_;
+	/// Implements caching for isXMonotonic(): true if the first xOrderCheckedCount_ points are sorted.
+	mutable bool xMonotonic_;
+	/// Implements caching for isXMonotonic(): the number of points (from the front) that have been checked.
+	mutable int xOrderCheckedCount_;
+	/// Set by aboutToChangeData(): true until the matching emitDataChanged(int, int).
+	bool rangeChangePrepared_;
+	/// Set by aboutToChangeData(): true if the x-values were sorted before the change.
+	bool rangeChangeWasSorted_;
+	/// Set by aboutToChangeData(): the number of old values saved in rangeChangeBuffer_, or 0 if the cached bounds weren't valid.
+	int rangeChangeOldCount_;
+	/// Scratch buffer for aboutToChangeData() and emitDataChanged(int, int): the old x-values followed by the old y-values.  Kept between calls so that single-point edits don't allocate.
+	QVector<qreal> rangeChangeBuffer_;
+
+	/// Extends the (valid) cached bounds to include the points from \c first to \c last.
+	void extendCachedBounds(int first, int last);
+	/// Expands [\c minX, \c maxX] and [\c minY, \c maxY] to include the points from \c first to \c last (inclusive), skipping NaN values.
+	/*! This is a single pass through the data, in chunks of MPLOT_BOUNDS_CHUNK_SIZE points: each chunk's x- and y-values are read directly from the model (xSpan() and ySpan()) when possible, or copied out with xValues() and yValues() otherwise, and reduced with MPlotSimd::minMax(). */
+	void searchBounds(int first, int last, qreal& minX, qreal& maxX, qreal& minY, qreal& maxY) const;
 
 
 
@@ -110,6 +197,10 @@ public:
 	virtual qreal y(unsigned index) const { return yValues_.at(index); }
 	/// Copy all the y values from \c indexStart to \c indexEnd (inclusive) into \c outputValues.  You can assume that the indexes are valid.
 	virtual void yValues(unsigned indexStart, unsigned indexEnd, qreal* outputValues) const { memcpy(outputValues, yValues_.constData()+indexStart, (indexEnd-indexStart+1)*sizeof(qreal)); }
+	/// Re-implemented to give direct access to the x values.
+	virtual MPlotDataSpan xSpan(unsigned indexStart, unsigned /*indexEnd*/) const { return MPlotDataSpan(xValues_.constData()+indexStart); }
+	/// Re-implemented to give direct access to the y values.
+	virtual MPlotDataSpan ySpan(unsigned indexStart, unsigned /*indexEnd*/) const { return MPlotDataSpan(yValues_.constData()+indexStart); }
 
 	/// Implements MPlotAbstractSeriesData: returns the number of data points.
 	virtual int count() const { return xValues_.count(); }
@@ -122,6 +213,11 @@ public:
 	/// Set a specific Y value. \c index must be in range for the current data, otherwise does nothing and returns false.
 	bool setYValue(int index, qreal yValue);
 
+	/// Appends \c n points at the end, copied from the \c x and \c y arrays. Only one change notification is issued for the whole block.
+	void insertPointsBack(const qreal* x, const qreal* y, int n);
+	/// Removes the first \c n points (or all of them, if there are fewer than \c n). Only one change notification is issued for the whole block.  Returns the number of points removed.
+	int removePointsFront(int n);
+
 
 
 protected:
@@ -130,11 +226,116 @@ protected:
 };
 
 
+/// Tracks the maximum (or minimum) value of a sliding window of points, using a monotonic deque.
+/*! Each value is identified by an absolute position, which must increase by one for each point added at the back of the window (and decrease by one for each point added at the front).  The deque only holds the points that could still become the extreme value as points are dropped from one end of the window, so pushing at either end and popping at that end cost O(1) amortized.
+
+  The end that points can be dropped from is chosen with clear(): PopFront (the default) for a window that slides forward, where points are added at the back and the oldest ones dropped from the front; PopBack for a window that slides backward.  Dropping points from the other end can't be handled incrementally, and neither can most changes to values in the middle (see replace()).  In those cases, clear() the tracker and push the whole window again.  NaN values are ignored.
+  */
+class MPLOTSHARED_EXPORT MPlotSlidingExtremum {
+
+public:
+	/// The end of the window that points can be dropped from.
+	enum PopEnd { PopFront, PopBack };
+
+	/// Constructs a tracker for the maximum value if \c trackMaximum is true, or for the minimum value otherwise.
+	MPlotSlidingExtremum(bool trackMaximum = true) : trackMaximum_(trackMaximum), popEnd_(PopFront) {}
+
+	/// Returns true if there are no (non-NaN) values in the window.
+	bool isEmpty() const { return candidates_.isEmpty(); }
+	/// Returns the extreme value in the window.  Only call when !isEmpty().
+	qreal value() const { return popEnd_ == PopFront ? candidates_.first().value : candidates_.last().value; }
+
+	/// Returns the end of the window that points can be dropped from.
+	PopEnd popEnd() const { return popEnd_; }
+	/// Forgets all the values in the window, and from now on allows dropping points from \c popEnd.
+	void clear(PopEnd popEnd = PopFront) { candidates_.clear(); popEnd_ = popEnd; }
+
+	/// Call when a point at \c position (one past the current back of the window) is added with \c value.
+	void pushBack(qint64 position, qreal value) {
+		if(value != value)
+			return;
+		if(popEnd_ == PopFront) {
+			while(!candidates_.isEmpty() && !beats(candidates_.last().value, value))
+				candidates_.removeLast();
+			candidates_.append(Candidate(position, value));
+		}
+		else if(candidates_.isEmpty() || beats(value, candidates_.last().value))
+			candidates_.append(Candidate(position, value));
+	}
+	/// Call when a point at \c position (one before the current front of the window) is added with \c value.
+	void pushFront(qint64 position, qreal value) {
+		if(value != value)
+			return;
+		if(popEnd_ == PopBack) {
+			while(!candidates_.isEmpty() && !beats(candidates_.first().value, value))
+				candidates_.removeFirst();
+			candidates_.prepend(Candidate(position, value));
+		}
+		else if(candidates_.isEmpty() || beats(value, candidates_.first().value))
+			candidates_.prepend(Candidate(position, value));
+	}
+	/// Call when the point at \c position (the current front of the window) is dropped.  Only allowed when popEnd() is PopFront.
+	void popFront(qint64 position) {
+		if(!candidates_.isEmpty() && candidates_.first().position == position)
+			candidates_.removeFirst();
+	}
+	/// Call when the point at \c position (the current back of the window) is dropped.  Only allowed when popEnd() is PopBack.
+	void popBack(qint64 position) {
+		if(!candidates_.isEmpty() && candidates_.last().position == position)
+			candidates_.removeLast();
+	}
+	/// Call when the value of the point at \c position (inside the window) changes to \c value.  Returns true if the tracker is still correct, which is the case when the point wasn't a candidate and still isn't: its new value doesn't beat the next candidate after it (or before it, for PopBack).  Otherwise, returns false, and the tracker must be re-filled.  O(log n).
+	bool replace(qint64 position, qreal value) {
+		// Binary search for the first candidate at or after position.
+		int lo = 0;
+		int hi = candidates_.count();
+		while(lo < hi) {
+			int mid = lo + (hi-lo)/2;
+			if(candidates_.at(mid).position < position)
+				lo = mid+1;
+			else
+				hi = mid;
+		}
+		if(lo < candidates_.count() && candidates_.at(lo).position == position)
+			return false;
+		if(value != value)
+			return true;
+		// The candidate that dominates this point: the next one after it for PopFront, or the last one before it for PopBack.
+		int dominant = (popEnd_ == PopFront) ? lo : lo-1;
+		return dominant >= 0 && dominant < candidates_.count() && !beats(value, candidates_.at(dominant).value);
+	}
+
+protected:
+	/// Returns true if \c a is strictly more extreme than \c b.
+	bool beats(qreal a, qreal b) const { return trackMaximum_ ? a > b : a < b; }
+
+	/// A point that could still become the extreme value of the window.
+	struct Candidate {
+		Candidate(qint64 p = 0, qreal v = 0) : position(p), value(v) {}
+		qint64 position;
+		qreal value;
+	};
+
+	/// The candidates, ordered by position.  For PopFront, their values are strictly decreasing (when tracking the maximum) or increasing (when tracking the minimum), so the front is always the extreme; for PopBack it's the other way around, and the back is the extreme.
+	MPlotRingBuffer<Candidate> candidates_;
+	/// True if tracking the maximum; false if tracking the minimum.
+	bool trackMaximum_;
+	/// The end of the window that points can be dropped from.
+	PopEnd popEnd_;
+};
+
+
 /// This class provides a Qt TableModel implementation of XY data.  It is optimized for fast storage of real-time data.
 /*! It provides fast (usually constant-time) lookups of the min and max values for each axis, which is important for plotting so that
 	// boundingRect() and autoscaling calls run quickly.
 
 When using for real-time data, calling insertPointFront and insertPointBack is very fast.
+
+The points are stored in contiguous circular buffers (MPlotRingBuffer), so adding or removing points at either end is constant-time, and xValues()/yValues() need at most two memcpy() calls.
+
+<b>Fixed-capacity mode</b>
+
+Use setFixedCapacity() to use the model as a strip-chart buffer: once it holds fixedCapacity() points, each insertPointBack() drops the oldest point from the front (and each insertPointFront() drops the newest point from the back).  The minimum and maximum values are tracked with monotonic deques (MPlotSlidingExtremum), so adding and evicting points costs O(1) amortized, no matter how many points are held, as long as the window keeps sliding the same way.  Changing direction (ex: removing points from the back after appending at the back, or from the front after inserting at the front), and editing values with setData() in a way that changes the extremes, schedule a single linear re-scan, which happens the next time boundingRect() is requested.
   */
 class MPLOTSHARED_EXPORT MPlotRealtimeModel : public QAbstractTableModel, public MPlotAbstractSeriesData {
 
@@ -151,6 +352,10 @@ public:
 	virtual void xValues(unsigned indexStart, unsigned indexEnd, qreal *outputValues) const;
 	virtual qreal y(unsigned index) const;
 	virtual void yValues(unsigned indexStart, unsigned indexEnd, qreal *outputValues) const;
+	/// Re-implemented to give direct access to the x values, when the range doesn't wrap around the end of the circular buffer.
+	virtual MPlotDataSpan xSpan(unsigned indexStart, unsigned indexEnd) const { return MPlotDataSpan(xval_.constData(indexStart, indexEnd-indexStart+1)); }
+	/// Re-implemented to give direct access to the y values, when the range doesn't wrap around the end of the circular buffer.
+	virtual MPlotDataSpan ySpan(unsigned indexStart, unsigned indexEnd) const { return MPlotDataSpan(yval_.constData(indexStart, indexEnd-indexStart+1)); }
 
 
 	QVariant data(const QModelIndex &index, int role) const;
@@ -168,12 +373,23 @@ public:
 	// This allows you to add data points at the end:
 	void insertPointBack(qreal x, qreal y);
 
+	/// Adds \c n points at the end, copied from the \c x and \c y arrays.  Use this instead of insertPointBack() when data arrives in blocks: the views are notified with a single beginInsertRows()/endInsertRows() pair, and only one dataChanged() signal is emitted.  In fixed-capacity mode, the oldest points are evicted from the front to make room (also with a single notification).
+	void insertPointsBack(const qreal* x, const qreal* y, int n);
+
 	// Remove a point at the front (Returns true if successful).
 	bool removePointFront();
 
 	// Remove a point at the back (returns true if successful)
 	bool removePointBack();
 
+	/// Removes the first \c n points (or all of them, if there are fewer than \c n), with a single change notification.  Returns the number of points removed.
+	int removePointsFront(int n);
+
+	/// Returns the maximum number of points held in fixed-capacity mode, or 0 if the model can grow without limit (the default).
+	int fixedCapacity() const { return fixedCapacity_; }
+	/// Turns on fixed-capacity mode, where the model holds at most \c capacity points.  Once full, insertPointBack() drops the oldest point from the front, and insertPointFront() drops the newest point from the back.  If the model currently holds more than \c capacity points, the oldest ones are removed.  Use 0 to let the model grow without limit.
+	void setFixedCapacity(int capacity);
+
 	virtual QRectF boundingRect() const;
 
 	// TODO: add properties: set and read axis names
@@ -181,29 +397,36 @@ public:
 protected:
 
 	// Members: Data arrays:
-	QQueue<qreal> xval_;
-	QQueue<qreal> yval_;
+	MPlotRingBuffer<qreal> xval_;
+	MPlotRingBuffer<qreal> yval_;
+
+	/// The maximum number of points held in fixed-capacity mode, or 0 for no limit.
+	int fixedCapacity_;
+	/// The absolute position of the point at index 0.  Positions identify points to the min/max trackers, and don't change as points are added or removed at the other end.
+	qint64 frontPosition_;
 
-	// Max/min index tracking:
-	int minYIndex_, maxYIndex_, minXIndex_, maxXIndex_;
+	// Max/min tracking:
+	mutable MPlotSlidingExtremum minX_, maxX_, minY_, maxY_;
+	/// True if the min/max trackers are out of date, and must be re-filled from all the points.
+	mutable bool extremaRescanRequired_;
+	/// The end that the trackers will drop points from after the next re-scan: the front while points are appended at the back, or the back while they're inserted at the front.
+	MPlotSlidingExtremum::PopEnd extremaPopEnd_;
 
 	//
 	QString xName_, yName_;
 
 
 	// Helper functions:
-	// Check if an added point @ index is the new min. or max record holder:
-	// Must call this AFTER adding both x and y to the xval_ and y_val lists.
-	void minMaxAddCheck(qreal x, qreal y, int index);
-
-	// Check if a point modified at index causes us to lose our record holders, or is a new record holder.
-	// Inserts the point (modifies the data array).
-	void minMaxChangeCheckX(qreal newVal, int index);
-	void minMaxChangeCheckY(qreal newVal, int index);
-
-	int searchMaxIndex(const QList<qreal>& list);
-
-	int searchMinIndex(const QList<qreal>& list);
+	/// Updates the min/max trackers after a point has been added at the back.
+	void extremaPushBack(qreal x, qreal y);
+	/// Updates the min/max trackers after a point has been added at the front.
+	void extremaPushFront(qreal x, qreal y);
+	/// Removes \c n points from the front of the data arrays, and from the min/max trackers. Does not notify views or emit any signals.
+	void dropFront(int n);
+	/// Removes \c n points from the back of the data arrays, and from the min/max trackers. Does not notify views or emit any signals.
+	void dropBack(int n);
+	/// Re-fills the min/max trackers from all the points.
+	void rescanExtrema() const;
 
 	// Warning: only call these if the list is not empty:
 	qreal minY() const;
@@ -214,6 +437,55 @@ protected:
 };
 
 
+/// The default number of points that can be waiting in an MPlotQueuedRealtimeModel.
+#define MPLOT_DEFAULT_INGEST_QUEUE_CAPACITY 65536
+/// The default interval (in milliseconds) at which an MPlotQueuedRealtimeModel moves waiting points into the model: about once per frame at 60 Hz.
+#define MPLOT_DEFAULT_DRAIN_INTERVAL 16
+
+/// An MPlotRealtimeModel that can be fed directly from an acquisition thread.
+/*! Like all series models, MPlotRealtimeModel must only be changed from the GUI thread, since its changes are handled synchronously by the plots that show it.  Sending every sample to the GUI thread with a queued signal costs an allocation and an event per sample.  Instead, one producer thread can call pushPoints() (or pushPoint()) at any time: the points go into a lock-free queue (MPlotSpscQueue), and a timer on the GUI thread moves everything that's waiting into the model with drain(), at most once per drainInterval().  Each drain is a single insertPointsBack(), so views get one notification per frame, no matter how many points arrived.
+
+  Only one thread may push points.  If the queue is full, the extra points are dropped and counted in droppedPointCount(); use a larger \c queueCapacity if that happens.
+  */
+class MPLOTSHARED_EXPORT MPlotQueuedRealtimeModel : public MPlotRealtimeModel {
+
+	Q_OBJECT
+
+public:
+	/// Constructs an empty model, whose queue can hold \c queueCapacity points waiting to be drained.
+	MPlotQueuedRealtimeModel(int queueCapacity = MPLOT_DEFAULT_INGEST_QUEUE_CAPACITY, QObject* parent = 0);
+
+	/// Producer thread: queues \c n points, copied from the \c x and \c y arrays.  Returns the number of points queued, which is less than \c n if the queue is full.  Never blocks.
+	int pushPoints(const qreal* x, const qreal* y, int n);
+	/// Producer thread: queues one point.  Returns false if the queue is full.
+	bool pushPoint(qreal x, qreal y) { return pushPoints(&x, &y, 1) == 1; }
+
+	/// Returns the number of points that were dropped by pushPoints() because the queue was full.  The count stops at INT_MAX instead of wrapping around.  Can be called from any thread.
+	int droppedPointCount() const;
+
+	/// Returns the interval (in milliseconds) between automatic drain()s.
+	int drainInterval() const { return drainTimer_.interval(); }
+	/// Sets the interval (in milliseconds) between automatic drain()s.  Use 0 to stop draining automatically, and call drain() yourself.
+	void setDrainInterval(int milliseconds);
+
+public slots:
+	/// GUI thread: moves all the queued points into the model, with a single change notification.  Returns the number of points moved.  Called automatically every drainInterval().
+	int drain();
+
+protected:
+	/// The points waiting to be added to the model.
+	MPlotSpscQueue<QPointF> queue_;
+	/// Drains the queue periodically.
+	QTimer drainTimer_;
+	/// The number of points dropped because the queue was full, saturating at INT_MAX.
+	QAtomicInt droppedPoints_;
+	/// Re-used by drain() to hold the points taken from the queue.
+	QVector<QPointF> drainBuffer_;
+	/// Re-used by drain() to split the points into x and y arrays for insertPointsBack().
+	QVector<qreal> drainX_, drainY_;
+};
+
+
 
 
 
@@ -0,0 +1,533 @@
+#ifndef __MPlotSimd_CPP__
+#define __MPlotSimd_CPP__
+
+#include "MPlot/MPlotSimd.h"
+
+#include <math.h>
+#include <float.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(MPLOT_NO_SIMD)
+#define MPLOT_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+// Scalar versions. These define the results that the vectorized versions must match.
+////////////////////////////
+
+static void affineScalar(int size, const double* input, double scale, double shift, double* output)
+{
+	for(int i = 0; i < size; i++)
+		output[i] = input[i]*scale + shift;
+}
+
+static inline double logAffineScalarValue(double value, double inputScale, double inputShift, double logFloor, double scale, double shift)
+{
+	value = value*inputScale + inputShift;
+	if(value <= 0.0)
+		value = logFloor;
+	return log10(value)*scale + shift;
+}
+
+static void logAffineScalar(int size, const double* input, double inputScale, double inputShift, double logFloor, double scale, double shift, double* output)
+{
+	for(int i = 0; i < size; i++)
+		output[i] = logAffineScalarValue(input[i], inputScale, inputShift, logFloor, scale, shift);
+}
+
+static void minMaxScalar(int size, const double* input, double* minValue, double* maxValue)
+{
+	double lo = *minValue;
+	double hi = *maxValue;
+	for(int i = 0; i < size; i++) {
+		double v = input[i];
+		if(v < lo)
+			lo = v;
+		if(v > hi)
+			hi = v;
+	}
+	*minValue = lo;
+	*maxValue = hi;
+}
+
+// The index is rounded like qRound() (which is int(u + 0.5) for u >= 0), but clamped before converting to int, so that huge and infinite values get the last color.  The comparisons are false for NaN, which gets the first color.
+static inline int colorIndexScalar(double value, double minimum, double range, double brightness, double contrast, double scale, double lastIndex)
+{
+	// Values outside the range get the end colors, whatever the brightness and contrast.  (The gamma transfer table in MPlotColorMap clamps the same way.)
+	double t = (value - minimum)/range;
+	if(t < 0.0)
+		t = 0.0;
+	else if(t > 1.0)
+		t = 1.0;
+
+	double u = (contrast*(t + brightness))*scale + 0.5;
+	if(!(u > 0.0))
+		return 0;
+	if(u > lastIndex)
+		return int(lastIndex);
+	return int(u);
+}
+
+static void colorLookupScalar(int size, const double* input, double minimum, double range, double brightness, double contrast, double scale, const unsigned int* colors, int colorCount, unsigned int* output)
+{
+	double lastIndex = double(colorCount-1);
+	for(int i = 0; i < size; i++)
+		output[i] = colors[colorIndexScalar(input[i], minimum, range, brightness, contrast, scale, lastIndex)];
+}
+
+static void colorLookupIndexesScalar(int size, const int* indexes, const unsigned int* colors, int colorCount, unsigned int* output)
+{
+	int lastIndex = colorCount-1;
+	for(int i = 0; i < size; i++) {
+		int index = indexes[i];
+		if(index < 0)
+			index = 0;
+		else if(index > lastIndex)
+			index = lastIndex;
+		output[i] = colors[index];
+	}
+}
+
+#ifdef MPLOT_SIMD_X86
+
+// Vectorized log10().
+/* x = m * 2^e, with m in [sqrt(1/2), sqrt(2)). Then ln(m) = 2*atanh(t), where t = (m-1)/(m+1) is in [-0.172, 0.172], and the series 2*(t + t^3/3 + ... + t^13/13) converges to a relative error below 1e-12.  The exponent field is converted to a double by OR-ing it into the mantissa of 2^52 and subtracting.
+
+  Only valid for normal, positive, finite x. Callers must patch up other lanes with the scalar version. */
+
+#define MPLOT_SIMD_LOG10_E 0.43429448190325182765
+#define MPLOT_SIMD_LN2 0.69314718055994530942
+#define MPLOT_SIMD_SQRT2 1.41421356237309504880
+
+__attribute__((target("sse2")))
+static inline __m128d log10Sse2(__m128d x)
+{
+	const __m128i mantissaMask = _mm_set1_epi64x(0x000FFFFFFFFFFFFFLL);
+	const __m128i one = _mm_set1_epi64x(0x3FF0000000000000LL);
+	const __m128i magic = _mm_set1_epi64x(0x4330000000000000LL);	// 2^52
+
+	__m128i bits = _mm_castpd_si128(x);
+	__m128d m = _mm_castsi128_pd(_mm_or_si128(_mm_and_si128(bits, mantissaMask), one));	// [1, 2)
+	__m128d e = _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(_mm_srli_epi64(bits, 52), magic)), _mm_set1_pd(4503599627370496.0 + 1023.0));
+
+	// Move m into [sqrt(1/2), sqrt(2))
+	__m128d big = _mm_cmpge_pd(m, _mm_set1_pd(MPLOT_SIMD_SQRT2));
+	m = _mm_or_pd(_mm_and_pd(big, _mm_mul_pd(m, _mm_set1_pd(0.5))), _mm_andnot_pd(big, m));
+	e = _mm_add_pd(e, _mm_and_pd(big, _mm_set1_pd(1.0)));
+
+	__m128d t = _mm_div_pd(_mm_sub_pd(m, _mm_set1_pd(1.0)), _mm_add_pd(m, _mm_set1_pd(1.0)));
+	__m128d t2 = _mm_mul_pd(t, t);
+	__m128d p = _mm_set1_pd(1.0/13.0);
+	p = _mm_add_pd(_mm_mul_pd(p, t2), _mm_set1_pd(1.0/11.0));
+	p = _mm_add_pd(_mm_mul_pd(p, t2), _mm_set1_pd(1.0/9.0));
+	p = _mm_add_pd(_mm_mul_pd(p, t2), _mm_set1_pd(1.0/7.0));
+	p = _mm_add_pd(_mm_mul_pd(p, t2), _mm_set1_pd(1.0/5.0));
+	p = _mm_add_pd(_mm_mul_pd(p, t2), _mm_set1_pd(1.0/3.0));
+	p = _mm_add_pd(_mm_mul_pd(p, t2), _mm_set1_pd(1.0));
+	__m128d lnM = _mm_mul_pd(_mm_mul_pd(p, t), _mm_set1_pd(2.0));
+
+	__m128d ln = _mm_add_pd(_mm_mul_pd(e, _mm_set1_pd(MPLOT_SIMD_LN2)), lnM);
+	return _mm_mul_pd(ln, _mm_set1_pd(MPLOT_SIMD_LOG10_E));
+}
+
+__attribute__((target("sse2")))
+static void affineSse2(int size, const double* input, double scale, double shift, double* output)
+{
+	__m128d a = _mm_set1_pd(scale);
+	__m128d b = _mm_set1_pd(shift);
+
+	int i = 0;
+	for(; i+2 <= size; i += 2)
+		_mm_storeu_pd(output+i, _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(input+i), a), b));
+
+	affineScalar(size-i, input+i, scale, shift, output+i);
+}
+
+__attribute__((target("sse2")))
+static void logAffineSse2(int size, const double* input, double inputScale, double inputShift, double logFloor, double scale, double shift, double* output)
+{
+	__m128d ia = _mm_set1_pd(inputScale);
+	__m128d ib = _mm_set1_pd(inputShift);
+	__m128d floorValue = _mm_set1_pd(logFloor);
+	__m128d zero = _mm_setzero_pd();
+	__m128d smallest = _mm_set1_pd(DBL_MIN);
+	__m128d largest = _mm_set1_pd(DBL_MAX);
+	__m128d a = _mm_set1_pd(scale);
+	__m128d b = _mm_set1_pd(shift);
+
+	int i = 0;
+	for(; i+2 <= size; i += 2) {
+		__m128d v = _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(input+i), ia), ib);
+		__m128d notPositive = _mm_cmple_pd(v, zero);
+		v = _mm_or_pd(_mm_and_pd(notPositive, floorValue), _mm_andnot_pd(notPositive, v));
+
+		// Denormal, infinite, or NaN lanes: do the block the slow way.  (Checked before storing anything, since output can be the same as input.)
+		__m128d special = _mm_or_pd(_mm_or_pd(_mm_cmplt_pd(v, smallest), _mm_cmpgt_pd(v, largest)), _mm_cmpunord_pd(v, v));
+		if(_mm_movemask_pd(special))
+			logAffineScalar(2, input+i, inputScale, inputShift, logFloor, scale, shift, output+i);
+		else
+			_mm_storeu_pd(output+i, _mm_add_pd(_mm_mul_pd(log10Sse2(v), a), b));
+	}
+
+	logAffineScalar(size-i, input+i, inputScale, inputShift, logFloor, scale, shift, output+i);
+}
+
+// minpd(v, acc) and maxpd(v, acc) return acc when v is NaN, so NaN values are skipped just like the comparisons in minMaxScalar().  Two accumulators per extreme hide the latency of the min and max instructions.
+__attribute__((target("sse2")))
+static void minMaxSse2(int size, const double* input, double* minValue, double* maxValue)
+{
+	__m128d lo0 = _mm_set1_pd(*minValue), lo1 = lo0;
+	__m128d hi0 = _mm_set1_pd(*maxValue), hi1 = hi0;
+
+	int i = 0;
+	for(; i+4 <= size; i += 4) {
+		__m128d v0 = _mm_loadu_pd(input+i);
+		__m128d v1 = _mm_loadu_pd(input+i+2);
+		lo0 = _mm_min_pd(v0, lo0);
+		lo1 = _mm_min_pd(v1, lo1);
+		hi0 = _mm_max_pd(v0, hi0);
+		hi1 = _mm_max_pd(v1, hi1);
+	}
+
+	double lo[4], hi[4];
+	_mm_storeu_pd(lo, lo0);
+	_mm_storeu_pd(lo+2, lo1);
+	_mm_storeu_pd(hi, hi0);
+	_mm_storeu_pd(hi+2, hi1);
+	for(int j = 0; j < 4; j++) {
+		if(lo[j] < *minValue)
+			*minValue = lo[j];
+		if(hi[j] > *maxValue)
+			*maxValue = hi[j];
+	}
+
+	minMaxScalar(size-i, input+i, minValue, maxValue);
+}
+
+__attribute__((target("avx2")))
+static inline __m256d log10Avx2(__m256d x)
+{
+	const __m256i mantissaMask = _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL);
+	const __m256i one = _mm256_set1_epi64x(0x3FF0000000000000LL);
+	const __m256i magic = _mm256_set1_epi64x(0x4330000000000000LL);
+
+	__m256i bits = _mm256_castpd_si256(x);
+	__m256d m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, mantissaMask), one));
+	__m256d e = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 52), magic)), _mm256_set1_pd(4503599627370496.0 + 1023.0));
+
+	__m256d big = _mm256_cmp_pd(m, _mm256_set1_pd(MPLOT_SIMD_SQRT2), _CMP_GE_OQ);
+	m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), big);
+	e = _mm256_add_pd(e, _mm256_and_pd(big, _mm256_set1_pd(1.0)));
+
+	__m256d t = _mm256_div_pd(_mm256_sub_pd(m, _mm256_set1_pd(1.0)), _mm256_add_pd(m, _mm256_set1_pd(1.0)));
+	__m256d t2 = _mm256_mul_pd(t, t);
+	__m256d p = _mm256_set1_pd(1.0/13.0);
+	p = _mm256_add_pd(_mm256_mul_pd(p, t2), _mm256_set1_pd(1.0/11.0));
+	p = _mm256_add_pd(_mm256_mul_pd(p, t2), _mm256_set1_pd(1.0/9.0));
+	p = _mm256_add_pd(_mm256_mul_pd(p, t2), _mm256_set1_pd(1.0/7.0));
+	p = _mm256_add_pd(_mm256_mul_pd(p, t2), _mm256_set1_pd(1.0/5.0));
+	p = _mm256_add_pd(_mm256_mul_pd(p, t2), _mm256_set1_pd(1.0/3.0));
+	p = _mm256_add_pd(_mm256_mul_pd(p, t2), _mm256_set1_pd(1.0));
+	__m256d lnM = _mm256_mul_pd(_mm256_mul_pd(p, t), _mm256_set1_pd(2.0));
+
+	__m256d ln = _mm256_add_pd(_mm256_mul_pd(e, _mm256_set1_pd(MPLOT_SIMD_LN2)), lnM);
+	return _mm256_mul_pd(ln, _mm256_set1_pd(MPLOT_SIMD_LOG10_E));
+}
+
+__attribute__((target("avx2")))
+static void affineAvx2(int size, const double* input, double scale, double shift, double* output)
+{
+	__m256d a = _mm256_set1_pd(scale);
+	__m256d b = _mm256_set1_pd(shift);
+
+	int i = 0;
+	for(; i+4 <= size; i += 4)
+		_mm256_storeu_pd(output+i, _mm256_add_pd(_mm256_mul_pd(_mm256_loadu_pd(input+i), a), b));
+
+	affineScalar(size-i, input+i, scale, shift, output+i);
+}
+
+__attribute__((target("avx2")))
+static void logAffineAvx2(int size, const double* input, double inputScale, double inputShift, double logFloor, double scale, double shift, double* output)
+{
+	__m256d ia = _mm256_set1_pd(inputScale);
+	__m256d ib = _mm256_set1_pd(inputShift);
+	__m256d floorValue = _mm256_set1_pd(logFloor);
+	__m256d zero = _mm256_setzero_pd();
+	__m256d smallest = _mm256_set1_pd(DBL_MIN);
+	__m256d largest = _mm256_set1_pd(DBL_MAX);
+	__m256d a = _mm256_set1_pd(scale);
+	__m256d b = _mm256_set1_pd(shift);
+
+	int i = 0;
+	for(; i+4 <= size; i += 4) {
+		__m256d v = _mm256_add_pd(_mm256_mul_pd(_mm256_loadu_pd(input+i), ia), ib);
+		v = _mm256_blendv_pd(v, floorValue, _mm256_cmp_pd(v, zero, _CMP_LE_OQ));
+
+		__m256d special = _mm256_or_pd(_mm256_or_pd(_mm256_cmp_pd(v, smallest, _CMP_LT_OQ), _mm256_cmp_pd(v, largest, _CMP_GT_OQ)), _mm256_cmp_pd(v, v, _CMP_UNORD_Q));
+		if(_mm256_movemask_pd(special))
+			logAffineScalar(4, input+i, inputScale, inputShift, logFloor, scale, shift, output+i);
+		else
+			_mm256_storeu_pd(output+i, _mm256_add_pd(_mm256_mul_pd(log10Avx2(v), a), b));
+	}
+
+	logAffineScalar(size-i, input+i, inputScale, inputShift, logFloor, scale, shift, output+i);
+}
+
+__attribute__((target("avx2")))
+static void minMaxAvx2(int size, const double* input, double* minValue, double* maxValue)
+{
+	__m256d lo0 = _mm256_set1_pd(*minValue), lo1 = lo0;
+	__m256d hi0 = _mm256_set1_pd(*maxValue), hi1 = hi0;
+
+	int i = 0;
+	for(; i+8 <= size; i += 8) {
+		__m256d v0 = _mm256_loadu_pd(input+i);
+		__m256d v1 = _mm256_loadu_pd(input+i+4);
+		lo0 = _mm256_min_pd(v0, lo0);
+		lo1 = _mm256_min_pd(v1, lo1);
+		hi0 = _mm256_max_pd(v0, hi0);
+		hi1 = _mm256_max_pd(v1, hi1);
+	}
+
+	double lo[8], hi[8];
+	_mm256_storeu_pd(lo, lo0);
+	_mm256_storeu_pd(lo+4, lo1);
+	_mm256_storeu_pd(hi, hi0);
+	_mm256_storeu_pd(hi+4, hi1);
+	for(int j = 0; j < 8; j++) {
+		if(lo[j] < *minValue)
+			*minValue = lo[j];
+		if(hi[j] > *maxValue)
+			*maxValue = hi[j];
+	}
+
+	minMaxScalar(size-i, input+i, minValue, maxValue);
+}
+
+// Color lookup: the same operations in the same order as colorIndexScalar().  maxpd(0, t) and minpd(1, t) keep NaN lanes NaN, so that maxpd(u, 0) then returns 0 for them.  Clamping in double before the (truncating) conversion matches the scalar branches.
+__attribute__((target("sse2")))
+static void colorLookupSse2(int size, const double* input, double minimum, double range, double brightness, double contrast, double scale, const unsigned int* colors, int colorCount, unsigned int* output)
+{
+	const __m128d vMinimum = _mm_set1_pd(minimum);
+	const __m128d vRange = _mm_set1_pd(range);
+	const __m128d vBrightness = _mm_set1_pd(brightness);
+	const __m128d vContrast = _mm_set1_pd(contrast);
+	const __m128d vScale = _mm_set1_pd(scale);
+	const __m128d vLast = _mm_set1_pd(double(colorCount-1));
+	const __m128d half = _mm_set1_pd(0.5);
+	const __m128d zero = _mm_setzero_pd();
+	const __m128d one = _mm_set1_pd(1.0);
+
+	int i = 0;
+	for(; i+4 <= size; i += 4) {
+		__m128d u0 = _mm_div_pd(_mm_sub_pd(_mm_loadu_pd(input+i), vMinimum), vRange);
+		__m128d u1 = _mm_div_pd(_mm_sub_pd(_mm_loadu_pd(input+i+2), vMinimum), vRange);
+		u0 = _mm_min_pd(one, _mm_max_pd(zero, u0));
+		u1 = _mm_min_pd(one, _mm_max_pd(zero, u1));
+		u0 = _mm_add_pd(_mm_mul_pd(_mm_mul_pd(vContrast, _mm_add_pd(u0, vBrightness)), vScale), half);
+		u1 = _mm_add_pd(_mm_mul_pd(_mm_mul_pd(vContrast, _mm_add_pd(u1, vBrightness)), vScale), half);
+		u0 = _mm_min_pd(_mm_max_pd(u0, zero), vLast);
+		u1 = _mm_min_pd(_mm_max_pd(u1, zero), vLast);
+
+		// No gather in SSE2: look the colors up one by one.
+		int index[4];
+		_mm_storeu_si128((__m128i*)index, _mm_unpacklo_epi64(_mm_cvttpd_epi32(u0), _mm_cvttpd_epi32(u1)));
+		output[i] = colors[index[0]];
+		output[i+1] = colors[index[1]];
+		output[i+2] = colors[index[2]];
+		output[i+3] = colors[index[3]];
+	}
+
+	colorLookupScalar(size-i, input+i, minimum, range, brightness, contrast, scale, colors, colorCount, output+i);
+}
+
+__attribute__((target("avx2")))
+static void colorLookupAvx2(int size, const double* input, double minimum, double range, double brightness, double contrast, double scale, const unsigned int* colors, int colorCount, unsigned int* output)
+{
+	const __m256d vMinimum = _mm256_set1_pd(minimum);
+	const __m256d vRange = _mm256_set1_pd(range);
+	const __m256d vBrightness = _mm256_set1_pd(brightness);
+	const __m256d vContrast = _mm256_set1_pd(contrast);
+	const __m256d vScale = _mm256_set1_pd(scale);
+	const __m256d vLast = _mm256_set1_pd(double(colorCount-1));
+	const __m256d half = _mm256_set1_pd(0.5);
+	const __m256d zero = _mm256_setzero_pd();
+	const __m256d one = _mm256_set1_pd(1.0);
+	const int* table = (const int*)colors;
+
+	int i = 0;
+	for(; i+8 <= size; i += 8) {
+		__m256d u0 = _mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(input+i), vMinimum), vRange);
+		__m256d u1 = _mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(input+i+4), vMinimum), vRange);
+		u0 = _mm256_min_pd(one, _mm256_max_pd(zero, u0));
+		u1 = _mm256_min_pd(one, _mm256_max_pd(zero, u1));
+		u0 = _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(vContrast, _mm256_add_pd(u0, vBrightness)), vScale), half);
+		u1 = _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(vContrast, _mm256_add_pd(u1, vBrightness)), vScale), half);
+		u0 = _mm256_min_pd(_mm256_max_pd(u0, zero), vLast);
+		u1 = _mm256_min_pd(_mm256_max_pd(u1, zero), vLast);
+
+		__m256i index = _mm256_set_m128i(_mm256_cvttpd_epi32(u1), _mm256_cvttpd_epi32(u0));
+		_mm256_storeu_si256((__m256i*)(output+i), _mm256_i32gather_epi32(table, index, 4));
+	}
+
+	colorLookupScalar(size-i, input+i, minimum, range, brightness, contrast, scale, colors, colorCount, output+i);
+}
+
+__attribute__((target("avx2")))
+static void colorLookupIndexesAvx2(int size, const int* indexes, const unsigned int* colors, int colorCount, unsigned int* output)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i vLast = _mm256_set1_epi32(colorCount-1);
+	const int* table = (const int*)colors;
+
+	int i = 0;
+	for(; i+8 <= size; i += 8) {
+		__m256i index = _mm256_loadu_si256((const __m256i*)(indexes+i));
+		index = _mm256_min_epi32(_mm256_max_epi32(index, zero), vLast);
+		_mm256_storeu_si256((__m256i*)(output+i), _mm256_i32gather_epi32(table, index, 4));
+	}
+
+	colorLookupIndexesScalar(size-i, indexes+i, colors, colorCount, output+i);
+}
+
+#endif // MPLOT_SIMD_X86
+
+
+// Dispatch
+////////////////////////////
+
+typedef void (*MPlotSimdAffineFunction)(int, const double*, double, double, double*);
+typedef void (*MPlotSimdLogAffineFunction)(int, const double*, double, double, double, double, double, double*);
+typedef void (*MPlotSimdMinMaxFunction)(int, const double*, double*, double*);
+typedef void (*MPlotSimdColorLookupFunction)(int, const double*, double, double, double, double, double, const unsigned int*, int, unsigned int*);
+typedef void (*MPlotSimdColorLookupIndexesFunction)(int, const int*, const unsigned int*, int, unsigned int*);
+
+/// The kernels chosen for this CPU.
+struct MPlotSimdKernels {
+	MPlotSimdKernels() {
+		name = "scalar";
+		affine = affineScalar;
+		logAffine = logAffineScalar;
+		minMax = minMaxScalar;
+		colorLookup = colorLookupScalar;
+		colorLookupIndexes = colorLookupIndexesScalar;
+
+#ifdef MPLOT_SIMD_X86
+		__builtin_cpu_init();
+		if(__builtin_cpu_supports("avx2")) {
+			name = "AVX2";
+			affine = affineAvx2;
+			logAffine = logAffineAvx2;
+			minMax = minMaxAvx2;
+			colorLookup = colorLookupAvx2;
+			colorLookupIndexes = colorLookupIndexesAvx2;
+		}
+		else if(__builtin_cpu_supports("sse2")) {
+			name = "SSE2";
+			affine = affineSse2;
+			logAffine = logAffineSse2;
+			minMax = minMaxSse2;
+			colorLookup = colorLookupSse2;
+		}
+#endif
+	}
+
+	const char* name;
+	MPlotSimdAffineFunction affine;
+	MPlotSimdLogAffineFunction logAffine;
+	MPlotSimdMinMaxFunction minMax;
+	MPlotSimdColorLookupFunction colorLookup;
+	MPlotSimdColorLookupIndexesFunction colorLookupIndexes;
+};
+
+static const MPlotSimdKernels& kernels()
+{
+	static MPlotSimdKernels k;
+	return k;
+}
+
+// The kernels work on doubles. If qreal is float (ex: some ARM builds), these overloads fall back to scalar loops.
+static inline void affineDispatch(int size, const double* input, double scale, double shift, double* output)
+{
+	kernels().affine(size, input, scale, shift, output);
+}
+
+static inline void affineDispatch(int size, const float* input, float scale, float shift, float* output)
+{
+	for(int i = 0; i < size; i++)
+		output[i] = input[i]*scale + shift;
+}
+
+static inline void logAffineDispatch(int size, const double* input, double inputScale, double inputShift, double logFloor, double scale, double shift, double* output)
+{
+	kernels().logAffine(size, input, inputScale, inputShift, logFloor, scale, shift, output);
+}
+
+static inline void logAffineDispatch(int size, const float* input, float inputScale, float inputShift, float logFloor, float scale, float shift, float* output)
+{
+	for(int i = 0; i < size; i++) {
+		float value = input[i]*inputScale + inputShift;
+		if(value <= 0.0f)
+			value = logFloor;
+		output[i] = log10f(value)*scale + shift;
+	}
+}
+
+static inline void minMaxDispatch(int size, const double* input, double& minValue, double& maxValue)
+{
+	kernels().minMax(size, input, &minValue, &maxValue);
+}
+
+static inline void minMaxDispatch(int size, const float* input, float& minValue, float& maxValue)
+{
+	for(int i = 0; i < size; i++) {
+		if(input[i] < minValue)
+			minValue = input[i];
+		if(input[i] > maxValue)
+			maxValue = input[i];
+	}
+}
+
+static inline void colorLookupDispatch(int size, const double* input, double minimum, double range, double brightness, double contrast, double scale, const unsigned int* colors, int colorCount, unsigned int* output)
+{
+	kernels().colorLookup(size, input, minimum, range, brightness, contrast, scale, colors, colorCount, output);
+}
+
+static inline void colorLookupDispatch(int size, const float* input, float minimum, float range, float brightness, float contrast, float scale, const unsigned int* colors, int colorCount, unsigned int* output)
+{
+	double lastIndex = double(colorCount-1);
+	for(int i = 0; i < size; i++)
+		output[i] = colors[colorIndexScalar(input[i], minimum, range, brightness, contrast, scale, lastIndex)];
+}
+
+void MPlotSimd::affine(int size, const qreal *input, qreal scale, qreal shift, qreal *outputValues)
+{
+	affineDispatch(size, input, scale, shift, outputValues);
+}
+
+void MPlotSimd::logAffine(int size, const qreal *input, qreal inputScale, qreal inputShift, qreal logFloor, qreal scale, qreal shift, qreal *outputValues)
+{
+	logAffineDispatch(size, input, inputScale, inputShift, logFloor, scale, shift, outputValues);
+}
+
+void MPlotSimd::minMax(int size, const qreal *input, qreal &minValue, qreal &maxValue)
+{
+	minMaxDispatch(size, input, minValue, maxValue);
+}
+
+void MPlotSimd::colorLookup(int size, const qreal *input, qreal minimum, qreal range, qreal brightness, qreal contrast, qreal scale, const unsigned int *colors, int colorCount, unsigned int *outputValues)
+{
+	colorLookupDispatch(size, input, minimum, range, brightness, contrast, scale, colors, colorCount, outputValues);
+}
+
+void MPlotSimd::colorLookup(int size, const int *indexes, const unsigned int *colors, int colorCount, unsigned int *outputValues)
+{
+	kernels().colorLookupIndexes(size, indexes, colors, colorCount, outputValues);
+}
+
+const char * MPlotSimd::instructionSet()
+{
+	return sizeof(qreal) == sizeof(double) ? kernels().name : "scalar";
+}
+
+#endif
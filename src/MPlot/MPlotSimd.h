@@ -0,0 +1,31 @@
+#ifndef MPLOTSIMD_H
+#define MPLOTSIMD_H
+
+#include "MPlot/MPlot_global.h"
+
+/// Vectorized kernels for the innermost per-point loops of the plotting pipeline.
+/*! On x86 with GCC or Clang, each kernel has an SSE2 and an AVX2 implementation, and the fastest one supported by the CPU is chosen the first time a kernel is called.  Everywhere else (or when qreal is float), a plain scalar loop is used.  All implementations give the same results as the scalar loop, except that the vectorized log10() is an approximation with a relative error below 1e-12 (far smaller than a pixel), and minMax() may return either sign for an extreme of zero when both 0.0 and -0.0 are present.
+
+  The input and output arrays may be the same.
+  */
+namespace MPlotSimd {
+
+	/// outputValues[i] = input[i]*scale + shift
+	MPLOTSHARED_EXPORT void affine(int size, const qreal* input, qreal scale, qreal shift, qreal* outputValues);
+
+	/// Computes v = input[i]*inputScale + inputShift, replaces v with \c logFloor if v <= 0, and then sets outputValues[i] = log10(v)*scale + shift.  \c logFloor must be > 0.  NaN and infinite values are handled like log10() does.
+	MPLOTSHARED_EXPORT void logAffine(int size, const qreal* input, qreal inputScale, qreal inputShift, qreal logFloor, qreal scale, qreal shift, qreal* outputValues);
+
+	/// Expands [\c minValue, \c maxValue] to include the \c size values in \c input, skipping NaN values.  To find the extremes of several arrays in turn, start with minValue = +infinity and maxValue = -infinity; if every value was NaN, they are left unchanged.
+	MPLOTSHARED_EXPORT void minMax(int size, const qreal* input, qreal& minValue, qreal& maxValue);
+
+	/// Looks up a color for each value in \c input: outputValues[i] = colors[k], where k = qRound((contrast*(t + brightness))*scale), clamped to [0, \c colorCount-1], and t is (input[i] - minimum)/range clamped to [0, 1].  NaN values get colors[0].  \c colorCount must be > 0.
+	MPLOTSHARED_EXPORT void colorLookup(int size, const qreal* input, qreal minimum, qreal range, qreal brightness, qreal contrast, qreal scale, const unsigned int* colors, int colorCount, unsigned int* outputValues);
+	/// Looks up a color for each index in \c indexes: outputValues[i] = colors[indexes[i]], with the index clamped to [0, \c colorCount-1].  \c colorCount must be > 0.
+	MPLOTSHARED_EXPORT void colorLookup(int size, const int* indexes, const unsigned int* colors, int colorCount, unsigned int* outputValues);
+
+	/// Returns the name of the instruction set used by the kernels on this machine: "AVX2", "SSE2", or "scalar".
+	MPLOTSHARED_EXPORT const char* instructionSet();
+}
+
+#endif // MPLOTSIMD_H
@@ -0,0 +1,100 @@
+#ifndef MPLOTSPSCQUEUE_H
+#define MPLOTSPSCQUEUE_H
+
+#include "MPlot/MPlot_global.h"
+
+#include <QAtomicInt>
+
+/// A fixed-size, lock-free queue for passing values from exactly one producer thread to exactly one consumer thread.
+/*! The producer calls push(), and the consumer calls pop(); neither ever blocks or allocates memory.  Each side only writes its own position (tail_ for the producer, head_ for the consumer) and reads the other one with acquire semantics, so the values copied into the storage are always visible to the other thread before the position that publishes them.
+
+  The capacity is rounded up to a power of two.  When the queue is full, push() accepts as many values as fit and returns that number; it's up to the producer to decide whether to drop the rest or try again later.  T must be a type that can be copied with operator=() without allocating (ex: qreal, QPointF).
+
+  Any other use (several producers, or several consumers) needs external locking.
+  */
+template<class T>
+class MPlotSpscQueue {
+
+public:
+	/// Constructs an empty queue that can hold at least \c capacity values.
+	MPlotSpscQueue(int capacity) : head_(0), tail_(0) {
+		int size = 2;
+		while(size < capacity && size < (1 << 30))
+			size *= 2;
+		buffer_ = new T[size];
+		mask_ = size-1;
+	}
+	/// Destructor.  Make sure that neither thread is still using the queue.
+	~MPlotSpscQueue() { delete [] buffer_; }
+
+	/// Returns the maximum number of values that the queue can hold.
+	int capacity() const { return mask_+1; }
+	/// Returns the number of values waiting in the queue.  This is only a snapshot when the other thread is active.
+	int count() const { return int(unsigned(loadAcquire(tail_)) - unsigned(loadAcquire(head_))); }
+	/// Returns true if there are no values waiting in the queue (a snapshot, like count()).
+	bool isEmpty() const { return count() == 0; }
+
+	/// Producer thread only: adds up to \c n values from \c values at the back of the queue.  Returns the number of values added, which is less than \c n if the queue is full.
+	int push(const T* values, int n) {
+		unsigned tail = unsigned(loadAcquire(tail_));
+		unsigned head = unsigned(loadAcquire(head_));
+		int space = capacity() - int(tail - head);
+		if(n > space)
+			n = space;
+
+		for(int i = 0; i < n; ++i)
+			buffer_[(tail + unsigned(i)) & unsigned(mask_)] = values[i];
+
+		// Publish the new values to the consumer.
+		storeRelease(tail_, int(tail + unsigned(n)));
+		return n;
+	}
+
+	/// Consumer thread only: removes up to \c maxCount values from the front of the queue, and copies them into \c values.  Returns the number of values removed.
+	int pop(T* values, int maxCount) {
+		unsigned head = unsigned(loadAcquire(head_));
+		unsigned tail = unsigned(loadAcquire(tail_));
+		int n = int(tail - head);
+		if(n > maxCount)
+			n = maxCount;
+
+		for(int i = 0; i < n; ++i)
+			values[i] = buffer_[(head + unsigned(i)) & unsigned(mask_)];
+
+		// Hand the slots back to the producer.
+		storeRelease(head_, int(head + unsigned(n)));
+		return n;
+	}
+
+protected:
+	/// Reads \c value, with acquire semantics.
+	static int loadAcquire(const QAtomicInt& value) {
+#if QT_VERSION >= 0x050000
+		return value.loadAcquire();
+#else
+		return const_cast<QAtomicInt&>(value).fetchAndAddAcquire(0);
+#endif
+	}
+	/// Writes \c newValue into \c value, with release semantics.
+	static void storeRelease(QAtomicInt& value, int newValue) {
+#if QT_VERSION >= 0x050000
+		value.storeRelease(newValue);
+#else
+		value.fetchAndStoreRelease(newValue);
+#endif
+	}
+
+	/// The storage, with capacity() slots.
+	T* buffer_;
+	/// capacity()-1, used to wrap positions into the storage.
+	int mask_;
+	/// The position of the next value to pop.  Only written by the consumer.  Positions grow without limit (wrapping around), and are mapped into the storage with mask_.
+	QAtomicInt head_;
+	/// The position of the next value to push.  Only written by the producer.
+	QAtomicInt tail_;
+
+private:
+	Q_DISABLE_COPY(MPlotSpscQueue)
+};
+
+#endif // MPLOTSPSCQUEUE_H
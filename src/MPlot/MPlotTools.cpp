@@ -4,6 +4,7 @@
 #include "MPlot/MPlotTools.h"
 #include "MPlot/MPlotItem.h"
 #include "MPlot/MPlot.h"
+#include "MPlot/MPlotSeries.h"
 #include "MPlot/MPlotRectangle.h"
 
 #include <QDebug> // Required for below warnings. Todo: Look at AMErrorMon for MPlot(?) ~ Iain W.
@@ -35,8 +36,8 @@ void MPlotPlotSelectorTool::mousePressEvent ( QGraphicsSceneMouseEvent * event )
 	// Check all items for intersections
 	foreach(MPlotItem* s2, plot()->plotItems() ) {
 
-		// Have to verify that we actually intersect the shape... and that this guy is selectable
-		if(s2->selectable() && s2->shape().intersects(s2->mapRectFromScene(clickRegion))) {
+		// Have to verify that we actually hit the item... and that this guy is selectable
+		if(s2->selectable() && s2->hitTest(s2->mapRectFromScene(clickRegion))) {
 
 			selectedPossibilities << s2;	// add it to the list of selected possibilities
 		}
@@ -333,9 +334,30 @@ void MPlotDragZoomerTool::mouseDoubleClickEvent ( QGraphicsSceneMouseEvent * eve
 }
 
 
+/// Helper function for the tools that can snap to data: maps \c drawingPosition to the data coordinates of \c xAxisScale and \c yAxisScale.  (If either one is 0, that coordinate is left in drawing coordinates.)  If \c snap is true and \c plot has a series with any points, the closest data point is used instead of \c drawingPosition.
+static QPointF mapToDataSnapped(MPlot* plot, const QPointF& drawingPosition, const MPlotAxisScale* xAxisScale, const MPlotAxisScale* yAxisScale, bool snap)
+{
+	MPlotNearestPoint nearest;
+	if(snap && plot)
+		nearest = plot->nearestDataPoint(drawingPosition);
+
+	QPointF position = nearest.isValid() ? nearest.drawingPosition : drawingPosition;
+	qreal x = position.x();
+	qreal y = position.y();
+
+	// When the series uses the same axis scale, take its value directly, rather than mapping it there and back again.
+	if(xAxisScale)
+		x = (nearest.isValid() && nearest.series->xAxisTarget() == xAxisScale) ? nearest.value.x() : xAxisScale->mapDrawingToData(x);
+	if(yAxisScale)
+		y = (nearest.isValid() && nearest.series->yAxisTarget() == yAxisScale) ? nearest.value.y() : yAxisScale->mapDrawingToData(y);
+
+	return QPointF(x, y);
+}
+
 MPlotCursorTool::MPlotCursorTool()
 	: MPlotAbstractTool("Cursor", "Add cursor to plot") {
 
+	snapToData_ = false;
 }
 
 MPlotCursorTool::~MPlotCursorTool() {
@@ -425,15 +447,9 @@ void MPlotCursorTool::mousePressEvent ( QGraphicsSceneMouseEvent * event ) {
 		if(cursor->plot() != plot())
 			plot()->addItem(cursor);
 
-		qreal y = event->pos().y();
-		qreal x = event->pos().x();
-
-		if(cursor->yAxisTarget())
-			y = cursor->yAxisTarget()->mapDrawingToData(y);
-		if(cursor->xAxisTarget())
-			x = cursor->xAxisTarget()->mapDrawingToData(x);
-
-		QPointF newPos(x, y);
+		QPointF newPos = mapToDataSnapped(plot(), event->pos(), cursor->xAxisTarget(), cursor->yAxisTarget(), snapToData_);
+		qreal x = newPos.x();
+		qreal y = newPos.y();
 
 		cursor->setValue(newPos);
 		cursor->setDescription(QString("Cursor %1 (%2, %3)").arg(c).arg(x).arg(y));
@@ -499,6 +515,7 @@ MPlotDataPositionTool::MPlotDataPositionTool(bool useSelectionRect)
 
 	dragInProgress_ = false;
 	dragStarted_ = false;
+	snapToData_ = false;
 }
 
 MPlotDataPositionTool::~MPlotDataPositionTool()
@@ -665,7 +682,10 @@ void MPlotDataPositionTool::mousePressEvent ( QGraphicsSceneMouseEvent * event )
 {
 	if (event->button() == Qt::LeftButton) {
 		QPointF clickPos = event->pos();
-		setDrawingPosition(clickPos);
+		if (snapToData_ && indicator_ && indicator_->xAxisTarget() && indicator_->yAxisTarget())
+			setDataPosition(mapToDataSnapped(plot(), clickPos, indicator_->xAxisTarget(), indicator_->yAxisTarget(), true));
+		else
+			setDrawingPosition(clickPos);
 
 		if (useSelectionRect_){
 
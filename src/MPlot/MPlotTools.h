@@ -179,7 +179,9 @@ protected:
 
  \todo set active cursor (how? by selection? click and drag? programmatically?)
 
-  \todo multiple cursor modes: click, hover, dataSnap
+  Use setSnapToDataEnabled() to place cursors on the nearest data point instead of the exact click position.
+
+  \todo multiple cursor modes: click, hover
   */
 class MPLOTSHARED_EXPORT MPlotCursorTool : public MPlotAbstractTool {
 	Q_OBJECT
@@ -202,6 +204,11 @@ public:
 	/// add a cursor.  By default, cursors are added to the center of the existing plot.  You must specify the axis scales to attach this cursor to (and the axis scales must be valid for the current plot.)   (Use 0 for the y-axis scale if you want a vertical bar cursor, or 0 for the x-axis scale if you want a horizontal bar cursor.  If you don't provide any axis scales, the cursor won't be visible.)
 	void addCursor(MPlotAxisScale* yAxisScale, MPlotAxisScale* xAxisScale, const QPointF& initialPos = QPointF(0,0));
 
+	/// Returns true if clicking places the cursor on the nearest data point.
+	bool snapToDataEnabled() const { return snapToData_; }
+	/// Enables or disables snapping: when enabled, a click places the cursor on the closest point of any visible series in the plot (see MPlot::nearestDataPoint()), instead of exactly where the mouse is.  Disabled by default.
+	void setSnapToDataEnabled(bool enabled) { snapToData_ = enabled; }
+
 signals:
 	/// emitted when a new point is selected.  \c position is in coordinates based on the xAxisScale and yAxisScale set for that cursor
 	void valueChanged(unsigned cursorIndex, const QPointF& position);
@@ -210,6 +217,8 @@ protected:
 
 	/// list of plot point markers used as cursors
 	QList<MPlotPoint*> cursors_;
+	/// True if clicks should snap to the nearest data point.
+	bool snapToData_;
 
 
 	virtual void	mousePressEvent ( QGraphicsSceneMouseEvent * event );
@@ -240,6 +249,11 @@ public:
 	/// Returns the units for the data position indicator.
 	QStringList units() const { return units_; }
 
+	/// Returns true if clicking places the indicator on the nearest data point.
+	bool snapToDataEnabled() const { return snapToData_; }
+	/// Enables or disables snapping: when enabled, a click places the indicator on the closest point of any visible series in the plot (see MPlot::nearestDataPoint()), instead of exactly where the mouse is.  Disabled by default.
+	void setSnapToDataEnabled(bool enabled) { snapToData_ = enabled; }
+
 public slots:
 	/// Sets the position of the indicator, in drawing coordinates.
 	void setDrawingPosition(const QPointF &newPosition);
@@ -295,6 +309,8 @@ protected:
 	bool dragStarted_;
 	/// Means that a drag event is currently happening. We're in between exceeding the drag deadzone and finishing the drag.
 	bool dragInProgress_;
+	/// True if clicks should snap to the nearest data point.
+	bool snapToData_;
 };
 
 class MPLOTSHARED_EXPORT MPlotDataPositionCursorTool : public MPlotDataPositionTool
@@ -0,0 +1,180 @@
+#ifndef MPLOTTYPEDIMAGEDATA_H
+#define MPLOTTYPEDIMAGEDATA_H
+
+#include "MPlot/MPlotImageData.h"
+
+#include <QVector>
+#include <QRectF>
+
+#include <string.h>
+
+/// Image data that stores its z-values as \c T (ex: quint8, quint16, qint32, float) instead of qreal.
+/*! This is a drop-in replacement for MPlotSimpleImageData: the x- and y-values, the layout of the z-values (x varying the slowest), the range tracking and the change notifications all work the same way.  Only the storage is different: a 16-bit camera frame takes 2 bytes per pixel instead of 8, and the values are only converted to qreal when they are read with z() or zValues().
+
+  When \c T is quint8 or quint16, zIntegerBits() reports 8 or 16, and MPlotImageBasic colors the pixels straight from the stored values through a lookup table, without converting them to qreal at all.  The typedefs below cover the common cases.
+  */
+template<class T>
+class MPlotTypedImageData : public MPlotAbstractImageData {
+
+public:
+	/// Constructor: \c xSize by \c ySize values, all initialized to 0.
+	MPlotTypedImageData(int xSize, int ySize)
+		: MPlotAbstractImageData()
+	{
+		x_ = QVector<qreal>(xSize);
+		y_ = QVector<qreal>(ySize);
+		z_ = QVector<T>(xSize*ySize);
+	}
+
+	/// Return the x (independent data value) corresponding to \c indexX.
+	virtual qreal x(int indexX) const { return x_.at(indexX); }
+	/// Return the y (independendent data value) corresponding to \c indexY.
+	virtual qreal y(int indexY) const { return y_.at(indexY); }
+	/// Return the z = f(x,y) dependent data value corresponding (\c indexX, \c indexY), converted to qreal.
+	virtual qreal z(int indexX, int indexY) const { return qreal(z_.at(indexX*y_.size() + indexY)); }
+	/// Converts a block of z-values from (xStart,yStart) to (xEnd,yEnd) inclusive to qreal, into \c outputValues, with the x-axis varying the slowest.
+	virtual void zValues(int xStart, int yStart, int xEnd, int yEnd, qreal* outputValues) const { copyValues(xStart, yStart, xEnd, yEnd, outputValues); }
+
+	/// Returns 8 for quint8 values and 16 for quint16 values, so that images can color them through a lookup table.  Returns 0 for other types.
+	virtual int zIntegerBits() const { return integerBits(static_cast<const T*>(0)); }
+	/// Copies a block of z-values without converting them to qreal.  Only used when zIntegerBits() is not 0.
+	virtual void zIntegerValues(int xStart, int yStart, int xEnd, int yEnd, quint16* outputValues) const { copyValues(xStart, yStart, xEnd, yEnd, outputValues); }
+
+	/// Return the number of elements in x and y
+	virtual QPoint count() const { return QPoint(x_.size(), y_.size()); }
+	/// Return the bounds of the data (the rectangle containing the max/min x- and y-values)
+	virtual QRectF boundingRect() const { return boundingRect_; }
+
+	/// Returns the stored (unconverted) z-value at (\c indexX, \c indexY).
+	T rawZ(int indexX, int indexY) const { return z_.at(indexX*y_.size() + indexY); }
+	/// Direct access to the stored z-values, with the x-axis varying the slowest.
+	const T* constData() const { return z_.constData(); }
+
+	/// Set the z value at (\c indexX, \c indexY).
+	void setZ(int indexX, int indexY, T z) {
+		qreal value = qreal(z);
+
+		if (range_.isNull()){
+
+			range_.setX(value);
+			range_.setY(value);
+		}
+
+		else {
+
+			if (value < range_.x())
+				range_.setX(value);
+
+			if (value > range_.y())
+				range_.setY(value);
+		}
+
+		z_[indexX*y_.size() + indexY] = z;
+		emitDataChanged(indexX, indexY, indexX, indexY);
+	}
+
+	/// Set a block of z values at once, from (\c xStart, \c yStart) to (\c xEnd, \c yEnd) inclusive.  \c newValues is in the same order as zValues(), with the x-axis varying the slowest.  Like MPlotSimpleImageData::setZValues(), the range becomes the range of the new values.
+	void setZValues(int xStart, int yStart, int xEnd, int yEnd, const T* newValues) {
+		int ySize = y_.size();
+		int jSize = yEnd-yStart+1;
+		T rangeMinimum = newValues[0];
+		T rangeMaximum = newValues[0];
+
+		for (int i = 0, iSize = xEnd-xStart+1; i < iSize; i++){
+
+			const T* source = newValues + i*jSize;
+			T* column = z_.data() + (i+xStart)*ySize + yStart;
+
+			for (int j = 0; j < jSize; j++){
+
+				T newValue = source[j];
+
+				if (newValue > rangeMaximum)
+					rangeMaximum = newValue;
+
+				if (newValue < rangeMinimum)
+					rangeMinimum = newValue;
+			}
+
+			memcpy(column, source, jSize*sizeof(T));
+		}
+
+		range_ = MPlotRange(qreal(rangeMinimum), qreal(rangeMaximum));
+
+		emitDataChanged(xStart, yStart, xEnd, yEnd);
+	}
+
+	/// Set a block x values at once.
+	void setXValues(int start, int end, const qreal* newValues) {
+		memcpy(x_.data()+start, newValues, (end-start+1)*sizeof(qreal));
+		recomputeBoundingRect();
+		emitBoundsChanged();
+	}
+	/// Set a block of y values at once.
+	void setYValues(int start, int end, const qreal* newValues) {
+		memcpy(y_.data()+start, newValues, (end-start+1)*sizeof(qreal));
+		recomputeBoundingRect();
+		emitBoundsChanged();
+	}
+
+protected:
+	/// Copies the block of z-values from (xStart,yStart) to (xEnd,yEnd) into \c outputValues, converting them to \c U.  Each x-index is a contiguous run of y-values, so the inner loop is a plain conversion that the compiler can vectorize.
+	template<class U>
+	void copyValues(int xStart, int yStart, int xEnd, int yEnd, U* outputValues) const {
+		int ySize = y_.size();
+		int jSize = yEnd-yStart+1;
+
+		for (int i = 0, iSize = xEnd-xStart+1; i < iSize; i++){
+
+			const T* column = z_.constData() + (i+xStart)*ySize + yStart;
+			U* output = outputValues + i*jSize;
+
+			for (int j = 0; j < jSize; j++)
+				output[j] = U(column[j]);
+		}
+	}
+
+	/// 8-bit values can be colored through a 256-entry table.
+	static int integerBits(const quint8*) { return 8; }
+	/// 16-bit values can be colored through a 65536-entry table.
+	static int integerBits(const quint16*) { return 16; }
+	/// Other types are converted to qreal.
+	template<class U>
+	static int integerBits(const U*) { return 0; }
+
+	/// Recompute the bounding rectangle.
+	void recomputeBoundingRect() {
+		qreal minimumX = x_.first();
+		qreal maximumX = x_.last();
+		qreal minimumY = y_.first();
+		qreal maximumY = y_.last();
+
+		if(maximumX < minimumX)
+			qSwap(minimumX, maximumX);
+
+		if(maximumY < minimumY)
+			qSwap(minimumY, maximumY);
+
+		boundingRect_ = QRectF(minimumX, minimumY, maximumX-minimumX, maximumY-minimumY);
+	}
+
+	/// The x-values.
+	QVector<qreal> x_;
+	/// The y-values.
+	QVector<qreal> y_;
+	/// The z-values, with the x-index varying the slowest.
+	QVector<T> z_;
+	/// the (min/max) (x/y) values, in physical(data) coordinates. bounds_.upperLeft is == (minX, minY)
+	QRectF boundingRect_;
+};
+
+/// 8-bit unsigned pixels.
+typedef MPlotTypedImageData<quint8> MPlotUInt8ImageData;
+/// 16-bit unsigned pixels (ex: from a camera).
+typedef MPlotTypedImageData<quint16> MPlotUInt16ImageData;
+/// 32-bit signed pixels.
+typedef MPlotTypedImageData<qint32> MPlotInt32ImageData;
+/// Single-precision pixels.
+typedef MPlotTypedImageData<float> MPlotFloatImageData;
+
+#endif // MPLOTTYPEDIMAGEDATA_H
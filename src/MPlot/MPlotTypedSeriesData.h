@@ -0,0 +1,271 @@
+#ifndef MPLOTTYPEDSERIESDATA_H
+#define MPLOTTYPEDSERIESDATA_H
+
+#include "MPlot/MPlotSeriesData.h"
+#include "MPlot/MPlotRingBuffer.h"
+
+#include <QVector>
+#include <QRectF>
+
+/// Series data that stores its x- and y-values as \c XType and \c YType (ex: float, qint16, qint32) instead of qreal.
+/*! The values are only converted to qreal when they are read.  The paint pipeline reads them with xValues() and yValues(), one chunk of MPLOT_MAPPING_CHUNK_SIZE points at a time, right before mapping them to drawing coordinates; so the conversion happens in cache-sized pieces while drawing, instead of once for every point when it arrives.  Storing float values takes half the memory (and memory bandwidth) of MPlotVectorSeriesData, and 16-bit samples take a quarter.
+
+  The points are held in ring buffers, so adding points at the back and removing them from the front are both O(1).  Like MPlotRealtimeModel, the model can be used as a strip-chart buffer with setFixedCapacity(), and the minimum and maximum values are tracked with MPlotSlidingExtremum, so boundingRect() stays O(1) while points stream through.
+
+  XType and YType must be arithmetic types that convert to qreal.  The typedefs below cover the common cases.  When a type is qreal itself, xSpan() and ySpan() give direct access to the stored values.
+  */
+template<class XType, class YType = XType>
+class MPlotTypedSeriesData : public MPlotAbstractSeriesData {
+
+public:
+	/// Constructs an empty model.  If \c fixedCapacity is greater than 0, the model holds at most that many points (see setFixedCapacity()).
+	MPlotTypedSeriesData(int fixedCapacity = 0)
+		: minX_(false), maxX_(true), minY_(false), maxY_(true)
+	{
+		fixedCapacity_ = qMax(0, fixedCapacity);
+		frontPosition_ = 0;
+		extremaRescanRequired_ = false;
+		x_.reserve(fixedCapacity_);
+		y_.reserve(fixedCapacity_);
+	}
+
+	/// Returns the x-value at \c index, converted to qreal.
+	virtual qreal x(unsigned index) const { return qreal(x_.at(int(index))); }
+	/// Converts the x-values from \c indexStart to \c indexEnd (inclusive) to qreal, into \c outputValues.
+	virtual void xValues(unsigned indexStart, unsigned indexEnd, qreal* outputValues) const { convertValues(x_, int(indexStart), int(indexEnd)-int(indexStart)+1, outputValues); }
+	/// Returns the y-value at \c index, converted to qreal.
+	virtual qreal y(unsigned index) const { return qreal(y_.at(int(index))); }
+	/// Converts the y-values from \c indexStart to \c indexEnd (inclusive) to qreal, into \c outputValues.
+	virtual void yValues(unsigned indexStart, unsigned indexEnd, qreal* outputValues) const { convertValues(y_, int(indexStart), int(indexEnd)-int(indexStart)+1, outputValues); }
+
+	/// Direct access to the x-values, when XType is qreal and the values don't wrap around the end of the ring buffer.  Otherwise returns a null span.
+	virtual MPlotDataSpan xSpan(unsigned indexStart, unsigned indexEnd) const { return directSpan(x_, int(indexStart), int(indexEnd)-int(indexStart)+1); }
+	/// Direct access to the y-values, when YType is qreal and the values don't wrap around the end of the ring buffer.  Otherwise returns a null span.
+	virtual MPlotDataSpan ySpan(unsigned indexStart, unsigned indexEnd) const { return directSpan(y_, int(indexStart), int(indexEnd)-int(indexStart)+1); }
+
+	/// Returns the number of points.
+	virtual int count() const { return x_.count(); }
+
+	/// Returns the bounds of the data, from the sliding min/max trackers.  O(1), unless a re-scan was scheduled by setValues().
+	virtual QRectF boundingRect() const {
+		if(x_.isEmpty())
+			return QRectF();	// No data... return an invalid QRectF
+
+		if(extremaRescanRequired_)
+			rescanExtrema();
+
+		qreal minX = minX_.isEmpty() ? 0.0 : minX_.value();
+		qreal maxX = maxX_.isEmpty() ? 0.0 : maxX_.value();
+		qreal minY = minY_.isEmpty() ? 0.0 : minY_.value();
+		qreal maxY = maxY_.isEmpty() ? 0.0 : maxY_.value();
+		return QRectF(minX, minY, maxX-minX, maxY-minY);
+	}
+
+	/// Returns the stored (unconverted) x-value at \c index.
+	XType rawX(int index) const { return x_.at(index); }
+	/// Returns the stored (unconverted) y-value at \c index.
+	YType rawY(int index) const { return y_.at(index); }
+
+	/// Replaces all the points with \c xValues and \c yValues.  Returns false (and does nothing) if they are not the same size.
+	bool setValues(const QVector<XType>& xValues, const QVector<YType>& yValues) {
+		if(xValues.count() != yValues.count())
+			return false;
+
+		x_.clear();
+		y_.clear();
+
+		// In fixed-capacity mode, only the last fixedCapacity_ points are kept.
+		int first = (fixedCapacity_ > 0) ? qMax(0, xValues.count()-fixedCapacity_) : 0;
+		x_.reserve(xValues.count()-first);
+		y_.reserve(yValues.count()-first);
+		for(int i = first, cc = xValues.count(); i < cc; ++i) {
+			x_.append(xValues.at(i));
+			y_.append(yValues.at(i));
+		}
+
+		frontPosition_ = 0;
+		extremaRescanRequired_ = true;
+		emitDataChanged();
+		return true;
+	}
+
+	/// Adds a point at the back.  In fixed-capacity mode, drops the oldest point if the model is full.
+	void insertPointBack(XType x, YType y) { insertPointsBack(&x, &y, 1); }
+	/// Adds \c n points at the back, from \c x and \c y.  In fixed-capacity mode, drops enough of the oldest points to make room, and views are notified once for the whole block.
+	void insertPointsBack(const XType* x, const YType* y, int n) {
+		if(n <= 0)
+			return;
+
+		// In fixed-capacity mode, only the last fixedCapacity_ points of the block can survive.
+		if(fixedCapacity_ > 0 && n > fixedCapacity_) {
+			x += n - fixedCapacity_;
+			y += n - fixedCapacity_;
+			n = fixedCapacity_;
+		}
+
+		int evicted = 0;
+		if(fixedCapacity_ > 0) {
+			int excess = x_.count() + n - fixedCapacity_;
+			if(excess > 0) {
+				dropFront(excess);
+				evicted = excess;
+			}
+		}
+
+		x_.reserve(x_.count()+n);
+		y_.reserve(y_.count()+n);
+		for(int i = 0; i < n; ++i) {
+			x_.append(x[i]);
+			y_.append(y[i]);
+			extremaPushBack(qreal(x[i]), qreal(y[i]));
+		}
+
+		emitDataShifted(evicted, n);
+	}
+
+	/// Removes up to \c n points from the front.  Returns the number of points removed.
+	int removePointsFront(int n) {
+		n = qMin(n, x_.count());
+		if(n <= 0)
+			return 0;
+
+		dropFront(n);
+		emitDataRemovedFront(n);
+		return n;
+	}
+
+	/// Removes all the points.
+	void clear() {
+		if(x_.isEmpty())
+			return;
+
+		x_.clear();
+		y_.clear();
+		minX_.clear();
+		maxX_.clear();
+		minY_.clear();
+		maxY_.clear();
+		frontPosition_ = 0;
+		extremaRescanRequired_ = false;
+		emitDataChanged();
+	}
+
+	/// The maximum number of points held, or 0 if there's no limit.
+	int fixedCapacity() const { return fixedCapacity_; }
+	/// Sets the maximum number of points held (0 for no limit).  Once the model is full, adding points at the back drops the same number of points from the front.  If the model already holds more than \c capacity points, the oldest ones are dropped right away.
+	void setFixedCapacity(int capacity) {
+		fixedCapacity_ = qMax(0, capacity);
+		if(fixedCapacity_ == 0)
+			return;
+
+		x_.reserve(fixedCapacity_);
+		y_.reserve(fixedCapacity_);
+
+		int excess = x_.count() - fixedCapacity_;
+		if(excess > 0) {
+			dropFront(excess);
+			emitDataRemovedFront(excess);
+		}
+	}
+
+protected:
+	/// Converts \c n values of \c values, starting at \c index, to qreal.  Contiguous runs are converted with a plain loop that the compiler can vectorize.
+	template<class T>
+	static void convertValues(const MPlotRingBuffer<T>& values, int index, int n, qreal* outputValues) {
+		if(n <= 0)
+			return;
+
+		const T* run = values.constData(index, n);
+		if(run) {
+			for(int i = 0; i < n; ++i)
+				outputValues[i] = qreal(run[i]);
+		}
+		else {
+			for(int i = 0; i < n; ++i)
+				outputValues[i] = qreal(values.at(index+i));
+		}
+	}
+	/// When the values are already stored as qreal, copies them with at most two memcpy() calls.
+	static void convertValues(const MPlotRingBuffer<qreal>& values, int index, int n, qreal* outputValues) {
+		values.copyValues(index, n, outputValues);
+	}
+
+	/// Values stored as qreal can be accessed directly, as long as they don't wrap around the end of the ring buffer.
+	static MPlotDataSpan directSpan(const MPlotRingBuffer<qreal>& values, int index, int n) { return MPlotDataSpan(values.constData(index, n)); }
+	/// Other types must be converted (see convertValues()).
+	template<class T>
+	static MPlotDataSpan directSpan(const MPlotRingBuffer<T>& values, int index, int n) { Q_UNUSED(values) Q_UNUSED(index) Q_UNUSED(n) return MPlotDataSpan(); }
+
+	/// Adds the point just appended at the back to the min/max trackers.
+	void extremaPushBack(qreal x, qreal y) {
+		// Trackers are going to be re-filled anyway.
+		if(extremaRescanRequired_)
+			return;
+
+		qint64 position = frontPosition_ + x_.count() - 1;
+		minX_.pushBack(position, x);
+		maxX_.pushBack(position, x);
+		minY_.pushBack(position, y);
+		maxY_.pushBack(position, y);
+	}
+
+	/// Removes \c n points from the front of the buffers and the trackers.
+	void dropFront(int n) {
+		if(!extremaRescanRequired_) {
+			for(int i = 0; i < n; ++i) {
+				qint64 position = frontPosition_ + i;
+				minX_.popFront(position);
+				maxX_.popFront(position);
+				minY_.popFront(position);
+				maxY_.popFront(position);
+			}
+		}
+
+		x_.removeFirst(n);
+		y_.removeFirst(n);
+		frontPosition_ += n;
+	}
+
+	/// Re-fills the min/max trackers from all the points.
+	void rescanExtrema() const {
+		minX_.clear();
+		maxX_.clear();
+		minY_.clear();
+		maxY_.clear();
+
+		for(int i = 0, cc = x_.count(); i < cc; ++i) {
+			qint64 position = frontPosition_ + i;
+			qreal x = qreal(x_.at(i));
+			qreal y = qreal(y_.at(i));
+			minX_.pushBack(position, x);
+			maxX_.pushBack(position, x);
+			minY_.pushBack(position, y);
+			maxY_.pushBack(position, y);
+		}
+
+		extremaRescanRequired_ = false;
+	}
+
+	/// The stored values.
+	MPlotRingBuffer<XType> x_;
+	MPlotRingBuffer<YType> y_;
+
+	/// The maximum number of points held, or 0 for no limit.
+	int fixedCapacity_;
+
+	/// Tracks the minimum and maximum values of the points held.
+	mutable MPlotSlidingExtremum minX_, maxX_, minY_, maxY_;
+	/// The absolute position (used by the trackers) of the point at index 0.  It grows by one for every point dropped from the front.
+	qint64 frontPosition_;
+	/// True when the trackers are out of date, and must be re-filled before the bounds are next needed.
+	mutable bool extremaRescanRequired_;
+};
+
+/// Single-precision x- and y-values.
+typedef MPlotTypedSeriesData<float, float> MPlotFloatSeriesData;
+/// 16-bit integer samples (ex: from an ADC), with 32-bit integer x-values (ex: sample numbers).
+typedef MPlotTypedSeriesData<qint32, qint16> MPlotInt16SeriesData;
+/// 32-bit integer x- and y-values.
+typedef MPlotTypedSeriesData<qint32, qint32> MPlotInt32SeriesData;
+
+#endif // MPLOTTYPEDSERIESDATA_H
@@ -3,6 +3,8 @@
 
 #include "MPlot/MPlotWidget.h"
 
+#include <QElapsedTimer>
+
 MPlotSceneAndView::MPlotSceneAndView(QWidget* parent) :
 		QGraphicsView(parent)
 {
@@ -79,5 +81,17 @@ void MPlotWidget::resizeEvent ( QResizeEvent * event ) {
 	}
 }
 
+void MPlotWidget::paintEvent ( QPaintEvent * event ) {
+	if(!plot_ || plot_->maximumUpdateRate() <= 0) {
+		MPlotSceneAndView::paintEvent(event);
+		return;
+	}
+
+	QElapsedTimer paintTime;
+	paintTime.start();
+	MPlotSceneAndView::paintEvent(event);
+	plot_->reportPaintTime(paintTime.nsecsElapsed()/1e6);
+}
+
 #endif
 
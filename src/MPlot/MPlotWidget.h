@@ -60,6 +60,8 @@ protected:
 
 	// On resize events: notify the plot to resize it, and fill the viewport with the canvas.
 	virtual void resizeEvent ( QResizeEvent * event );
+	/// Paints the view, and tells the plot how long that took (MPlot::reportPaintTime()), so that it can adapt its update rate.
+	virtual void paintEvent ( QPaintEvent * event );
 
 	// Member variables:
 	MPlot* plot_;